@@ -0,0 +1,1146 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <vxLib/Allocator/Mallocator.h>
+#include <vxLib/Allocator/LinearAllocator.h>
+#include <vxLib/Allocator/StackAllocator.h>
+#include <vxLib/Allocator/VirtualLinearAllocator.h>
+#include <vxLib/Allocator/PageAllocator.h>
+#include <vxLib/Allocator/BitmapBlock.h>
+#include <vxLib/Allocator/MultiBlockAllocator.h>
+#include <vxLib/Allocator/Freelist.h>
+#include <vxLib/Allocator/TlsfAllocator.h>
+#include <vxLib/Allocator/StatsAllocator.h>
+#include <vxLib/Allocator/Bucketizer.h>
+#include <vxLib/Allocator/FallbackAllocator.h>
+#include <vxLib/Allocator/CascadingAllocator.h>
+#include <vxLib/Allocator/BlockCompactor.h>
+#include <vxLib/Allocator/FrameAllocator.h>
+#include <vxLib/Allocator/GpuMultiBlockAllocator.h>
+#include <vxLib/Allocator/PmrAllocator.h>
+#include <vxLib/Allocator/DelegateAllocator.h>
+#include <vxLib/Allocator/SharedAllocator.h>
+#include <vxLib/Allocator/SharedLinearAllocator.h>
+#include <vxLib/Allocator/SharedFreelist.h>
+#include <vxLib/Allocator/SharedMultiBlockAllocator.h>
+#include <vxLib/Allocator/ThreadCacheAllocator.h>
+#include <vxLib/Container/DynamicArray.h>
+#include <vxLib/Container/InplaceArray.h>
+#include <vxLib/Container/ObjectPool.h>
+#include <vxLib/Container/SoaArray.h>
+#include <vxLib/Container/SegmentedArray.h>
+#include <vxLib/Container/SpscRing.h>
+#include <vxLib/Container/MpmcRing.h>
+#include <vxLib/math/Vector.h>
+#include <vxLib/Container/SortedArray.h>
+#include <vxLib/Container/HashMap.h>
+#include <vxLib/Container/string.h>
+#include <vxLib/StringID.h>
+#include <vxLib/JobSystem.h>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	// keeps the optimizer from removing allocations that are never touched
+	volatile size_t g_sink = 0;
+	u64 g_failed = 0;
+
+	const size_t ARENA_SIZE = 64 MBYTE;
+	const size_t SMALL_SIZE = 64;
+
+	inline void consume(const vx::AllocatedBlock &block)
+	{
+		g_sink += (size_t)block.ptr;
+		g_failed += (block.ptr == nullptr);
+	}
+
+	template<typename F>
+	void runBenchmark(const char* name, u32 rounds, u32 opsPerRound, F &&f)
+	{
+		f();
+		g_failed = 0;
+
+		auto start = Clock::now();
+		for (u32 i = 0; i < rounds; ++i)
+		{
+			f();
+		}
+		auto end = Clock::now();
+
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		auto ops = (f64)rounds * opsPerRound;
+
+		printf("%-48s %12.0f ops %10.3f ms %10.2f ns/op %8llu failed\n", name, ops, ns / 1000000.0, ns / ops, (unsigned long long)g_failed);
+	}
+
+	template<typename Alloc>
+	void allocateDeallocateFifo(Alloc* alloc, vx::AllocatedBlock* blocks, u32 count, size_t size, size_t alignment)
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			blocks[i] = alloc->allocate(size, alignment);
+			consume(blocks[i]);
+		}
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			alloc->deallocate(blocks[i]);
+		}
+	}
+
+	template<typename Alloc>
+	void allocateDeallocateLifo(Alloc* alloc, vx::AllocatedBlock* blocks, u32 count, size_t size, size_t alignment)
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			blocks[i] = alloc->allocate(size, alignment);
+			consume(blocks[i]);
+		}
+
+		for (u32 i = count; i > 0; --i)
+		{
+			alloc->deallocate(blocks[i - 1]);
+		}
+	}
+
+	void benchmarkAllocators(u32 rounds)
+	{
+		const u32 count = 4096;
+		std::unique_ptr<vx::AllocatedBlock[]> blocks(new vx::AllocatedBlock[count]);
+
+		vx::Mallocator mallocator;
+		auto arena = mallocator.allocate(ARENA_SIZE, 64);
+
+		{
+			vx::LinearAllocator alloc(arena);
+			runBenchmark("LinearAllocator allocate/deallocateAll", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					consume(alloc.allocate(SMALL_SIZE, 16));
+				}
+				alloc.deallocateAll();
+			});
+
+			runBenchmark("LinearAllocator allocate/deallocate lifo", rounds, count, [&]()
+			{
+				allocateDeallocateLifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+			});
+			alloc.release();
+		}
+
+		{
+			vx::VirtualLinearAllocator alloc(1024 MBYTE);
+			runBenchmark("VirtualLinearAllocator allocate/deallocateAll", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					consume(alloc.allocate(SMALL_SIZE, 16));
+				}
+				alloc.deallocateAll();
+			});
+		}
+
+		{
+			std::unique_ptr<vx::FrameAllocator<2, 4>> alloc(new vx::FrameAllocator<2, 4>(arena));
+			u64 fence = 0;
+			runBenchmark("FrameAllocator<2, 4> frame", rounds, count, [&]()
+			{
+				++fence;
+				alloc->retire(fence - 1);
+				alloc->beginFrame(fence);
+				for (u32 i = 0; i < count; ++i)
+				{
+					consume(alloc->allocate(i & 3, SMALL_SIZE, 16));
+				}
+			});
+			alloc->release();
+		}
+
+		{
+			typedef vx::StackAllocator<count * SMALL_SIZE, 16> MyStackAllocator;
+			std::unique_ptr<MyStackAllocator> alloc(new MyStackAllocator());
+			runBenchmark("StackAllocator allocate/deallocateAll", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					consume(alloc->allocate(SMALL_SIZE, 16));
+				}
+				alloc->deallocateAll();
+			});
+
+			runBenchmark("StackAllocator allocate/deallocate lifo", rounds, count, [&]()
+			{
+				allocateDeallocateLifo(alloc.get(), blocks.get(), count, SMALL_SIZE, 16);
+			});
+		}
+
+		{
+			vx::BitmapBlock<vx::LinearAllocator, SMALL_SIZE, 16> alloc({ arena.ptr, count * SMALL_SIZE * 2 });
+			runBenchmark("BitmapBlock<64> allocate/deallocate", rounds, count, [&]()
+			{
+				allocateDeallocateFifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+			});
+			alloc.release();
+		}
+
+		{
+			vx::MultiBlockAllocator<SMALL_SIZE, 16, 16> alloc({ arena.ptr, count * SMALL_SIZE * 16 });
+			runBenchmark("MultiBlockAllocator<64> 1 block", rounds, count, [&]()
+			{
+				allocateDeallocateFifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+			});
+
+			runBenchmark("MultiBlockAllocator<64> 1..16 blocks", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					blocks[i] = alloc.allocate(SMALL_SIZE * ((i & 15) + 1), 16);
+					consume(blocks[i]);
+				}
+
+				for (u32 i = 0; i < count; ++i)
+				{
+					alloc.deallocate(blocks[i]);
+				}
+			});
+			alloc.release();
+		}
+
+		{
+			vx::TlsfAllocator alloc(arena);
+			runBenchmark("TlsfAllocator 64 bytes", rounds, count, [&]()
+			{
+				allocateDeallocateFifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+			});
+
+			runBenchmark("TlsfAllocator 64..1024 bytes", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					blocks[i] = alloc.allocate(SMALL_SIZE * ((i & 15) + 1), 16);
+					consume(blocks[i]);
+				}
+
+				for (u32 i = 0; i < count; ++i)
+				{
+					alloc.deallocate(blocks[i]);
+				}
+			});
+			alloc.release();
+		}
+
+		{
+			typedef vx::Bucketizer<vx::MultiBlockAllocator<16, 16, 16>, 16, 256, 16> MyBucketizer;
+			MyBucketizer alloc(arena);
+			runBenchmark("Bucketizer<MultiBlock> 16..256 bytes", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					blocks[i] = alloc.allocate(16 * ((i & 15) + 1), 16);
+					consume(blocks[i]);
+				}
+
+				for (u32 i = 0; i < count; ++i)
+				{
+					alloc.deallocate(blocks[i]);
+				}
+			});
+			alloc.release();
+		}
+
+		{
+			typedef vx::MultiBlockAllocator<SMALL_SIZE, 16, 16> MyHeap;
+			std::unique_ptr<vx::ObjectPoolHandle[]> handles(new vx::ObjectPoolHandle[count]);
+
+			MyHeap heap({ arena.ptr, count * SMALL_SIZE * 8 });
+			vx::BlockCompactor<MyHeap> compactor(&heap);
+
+			// every round fragments the heap by freeing every other allocation and compacts it again
+			runBenchmark("BlockCompactor<MultiBlock> plan/step", rounds, count / 2, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					handles[i] = compactor.allocate(SMALL_SIZE * ((i & 3) + 1), 16);
+				}
+
+				for (u32 i = 0; i < count; i += 2)
+				{
+					compactor.deallocate(handles[i]);
+				}
+
+				compactor.plan();
+				while (!compactor.step(64 KBYTE))
+				{
+				}
+
+				for (u32 i = 1; i < count; i += 2)
+				{
+					compactor.deallocate(handles[i]);
+				}
+			});
+			heap.release();
+		}
+
+		{
+			// the primary holds a quarter of the blocks, the rest spills over
+			vx::FallbackAllocator<vx::MultiBlockAllocator<SMALL_SIZE, 16, 16>, vx::Mallocator> alloc(vx::AllocatedBlock{ arena.ptr, count * SMALL_SIZE / 4 }, vx::Mallocator());
+			runBenchmark("FallbackAllocator<MultiBlock, Mallocator>", rounds, count, [&]()
+			{
+				allocateDeallocateFifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+			});
+		}
+
+		{
+			vx::CascadingAllocator<vx::ArenaFactory<vx::MultiBlockAllocator<SMALL_SIZE, 16, 16>, vx::Mallocator, 64 KBYTE>> alloc;
+			runBenchmark("CascadingAllocator<MultiBlock, 64k arenas>", rounds, count, [&]()
+			{
+				allocateDeallocateFifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+			});
+		}
+
+		{
+			vx::Freelist<vx::LinearAllocator, 0, SMALL_SIZE, SMALL_SIZE> alloc(arena);
+			allocateDeallocateFifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+
+			runBenchmark("Freelist<LinearAllocator> recycle", rounds, count, [&]()
+			{
+				allocateDeallocateFifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+			});
+			alloc.release();
+		}
+
+		{
+			vx::StatsAllocator<vx::Freelist<vx::LinearAllocator, 0, SMALL_SIZE, SMALL_SIZE>, 0> alloc(arena);
+			allocateDeallocateFifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+
+			runBenchmark("StatsAllocator<Freelist> recycle", rounds, count, [&]()
+			{
+				allocateDeallocateFifo(&alloc, blocks.get(), count, SMALL_SIZE, 16);
+			});
+			alloc.release();
+		}
+
+		{
+			typedef vx::GpuMultiBlockAllocator<SMALL_SIZE, 16, 16> MyGpuAllocator;
+			const u64 capacity = count * SMALL_SIZE * 2;
+			std::unique_ptr<vx::GpuAllocatedBlock[]> gpuBlocks(new vx::GpuAllocatedBlock[count]);
+
+			MyGpuAllocator alloc(arena, capacity);
+			u64 fence = 0;
+			runBenchmark("GpuMultiBlockAllocator deferred/retire", rounds, count, [&]()
+			{
+				++fence;
+				for (u32 i = 0; i < count; ++i)
+				{
+					gpuBlocks[i] = alloc.allocate(SMALL_SIZE, 16);
+					g_sink += gpuBlocks[i].offset;
+				}
+
+				for (u32 i = 0; i < count; ++i)
+				{
+					alloc.deallocate(gpuBlocks[i], fence);
+				}
+				alloc.retire(fence);
+			});
+
+			MyGpuAllocator::Recorder recorder(&alloc, 16 * SMALL_SIZE);
+			runBenchmark("GpuMultiBlockAllocator::Recorder", rounds, count, [&]()
+			{
+				++fence;
+				recorder.begin(fence);
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_sink += recorder.allocate(48, 16).offset;
+				}
+				recorder.end();
+				alloc.retire(fence);
+			});
+			alloc.release();
+		}
+
+		{
+			runBenchmark("Mallocator allocate/deallocate", rounds, count, [&]()
+			{
+				allocateDeallocateFifo(&mallocator, blocks.get(), count, SMALL_SIZE, 16);
+			});
+		}
+
+		mallocator.deallocate(arena);
+
+		// touches one cache line per page, so page walks dominate
+		const vx::PageType pageTypes[] = { vx::PageType::Default, vx::PageType::TransparentHuge, vx::PageType::Huge };
+		const char* pageTypeNames[] = { "PageAllocator default pages touch", "PageAllocator transparent huge touch", "PageAllocator huge pages touch" };
+		for (u32 i = 0; i < 3; ++i)
+		{
+			vx::PageAllocator pages(pageTypes[i]);
+			vx::MultiBlockAllocator<4 KBYTE, 16, 1> alloc(pages.allocate(ARENA_SIZE, 64));
+			runBenchmark(pageTypeNames[i], rounds, count, [&]()
+			{
+				for (u32 j = 0; j < count; ++j)
+				{
+					blocks[j] = alloc.allocate(4 KBYTE, 16);
+					consume(blocks[j]);
+				}
+
+				for (u32 j = 0; j < count; ++j)
+				{
+					auto ptr = blocks[(j * 2053) & (count - 1)].ptr;
+					if (ptr)
+						g_sink += *ptr;
+				}
+
+				for (u32 j = 0; j < count; ++j)
+				{
+					alloc.deallocate(blocks[j]);
+				}
+			});
+			pages.deallocate(alloc.release());
+		}
+	}
+
+	// runs f(threadIndex) on threadCount threads and returns the summed failures
+	template<typename F>
+	u64 runThreads(u32 threadCount, F &&f)
+	{
+		std::atomic<u64> failed(0);
+		std::unique_ptr<std::thread[]> threads(new std::thread[threadCount]);
+		for (u32 i = 0; i < threadCount; ++i)
+		{
+			threads[i] = std::thread([&, i]()
+			{
+				failed.fetch_add(f(i), std::memory_order_relaxed);
+			});
+		}
+
+		for (u32 i = 0; i < threadCount; ++i)
+		{
+			threads[i].join();
+		}
+
+		return failed.load(std::memory_order_relaxed);
+	}
+
+	template<typename Alloc>
+	u64 sharedAllocateDeallocateFifo(Alloc* alloc, vx::AllocatedBlock* blocks, u32 count, size_t size, size_t alignment)
+	{
+		u64 failed = 0;
+		for (u32 i = 0; i < count; ++i)
+		{
+			blocks[i] = alloc->allocate(size, alignment);
+			failed += (blocks[i].ptr == nullptr);
+		}
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			alloc->deallocate(blocks[i]);
+		}
+
+		return failed;
+	}
+
+	void benchmarkSharedAllocators(u32 rounds)
+	{
+		const u32 threadCount = 4;
+		const u32 countPerThread = 1024;
+		const u32 count = threadCount * countPerThread;
+		std::unique_ptr<vx::AllocatedBlock[]> blocks(new vx::AllocatedBlock[count]);
+
+		vx::Mallocator mallocator;
+		auto arena = mallocator.allocate(ARENA_SIZE, 64);
+
+		{
+			vx::SharedLinearAllocator alloc(arena);
+			runBenchmark("SharedLinearAllocator 4 threads", rounds, count, [&]()
+			{
+				g_failed += runThreads(threadCount, [&](u32)
+				{
+					u64 failed = 0;
+					for (u32 i = 0; i < countPerThread; ++i)
+					{
+						failed += (alloc.allocate(SMALL_SIZE, 16).ptr == nullptr);
+					}
+					return failed;
+				});
+				alloc.deallocateAll();
+			});
+			alloc.release();
+		}
+
+		{
+			vx::SharedFreelist<vx::SharedLinearAllocator, 0, SMALL_SIZE, 16> alloc(arena);
+			runBenchmark("SharedFreelist 4 threads recycle", rounds, count, [&]()
+			{
+				g_failed += runThreads(threadCount, [&](u32 thread)
+				{
+					return sharedAllocateDeallocateFifo(&alloc, blocks.get() + thread * countPerThread, countPerThread, SMALL_SIZE, 16);
+				});
+			});
+		}
+
+		{
+			vx::SharedMultiBlockAllocator<SMALL_SIZE, 16, 16> alloc({ arena.ptr, count * SMALL_SIZE * 2 });
+			runBenchmark("SharedMultiBlockAllocator<64> 4 threads", rounds, count, [&]()
+			{
+				g_failed += runThreads(threadCount, [&](u32 thread)
+				{
+					return sharedAllocateDeallocateFifo(&alloc, blocks.get() + thread * countPerThread, countPerThread, SMALL_SIZE, 16);
+				});
+			});
+			alloc.release();
+		}
+
+		{
+			vx::SharedAllocator<vx::MultiBlockAllocator<SMALL_SIZE, 16, 16>> alloc({ arena.ptr, count * SMALL_SIZE * 2 });
+			runBenchmark("SharedAllocator<MultiBlock> 4 threads", rounds, count, [&]()
+			{
+				g_failed += runThreads(threadCount, [&](u32 thread)
+				{
+					return sharedAllocateDeallocateFifo(&alloc, blocks.get() + thread * countPerThread, countPerThread, SMALL_SIZE, 16);
+				});
+			});
+			alloc.release();
+		}
+
+		{
+			vx::SharedAllocator<vx::Mallocator> alloc;
+			runBenchmark("SharedAllocator<Mallocator> 4 threads", rounds, count, [&]()
+			{
+				g_failed += runThreads(threadCount, [&](u32 thread)
+				{
+					return sharedAllocateDeallocateFifo(&alloc, blocks.get() + thread * countPerThread, countPerThread, SMALL_SIZE, 16);
+				});
+			});
+		}
+
+		{
+			vx::ThreadCacheAllocator<vx::Mallocator, 64, 1024, 16, 256, 16> alloc;
+			runBenchmark("ThreadCacheAllocator 4 threads", rounds, count, [&]()
+			{
+				g_failed += runThreads(threadCount, [&](u32 thread)
+				{
+					return sharedAllocateDeallocateFifo(&alloc, blocks.get() + thread * countPerThread, countPerThread, SMALL_SIZE, 16);
+				});
+			});
+
+			// every thread frees the blocks of its neighbour
+			runBenchmark("ThreadCacheAllocator 4 threads remote", rounds, count, [&]()
+			{
+				g_failed += runThreads(threadCount, [&](u32 thread)
+				{
+					u64 failed = 0;
+					for (u32 i = 0; i < countPerThread; ++i)
+					{
+						blocks[thread * countPerThread + i] = alloc.allocate(SMALL_SIZE, 16);
+						failed += (blocks[thread * countPerThread + i].ptr == nullptr);
+					}
+					return failed;
+				});
+
+				runThreads(threadCount, [&](u32 thread)
+				{
+					auto other = (thread + 1) % threadCount;
+					for (u32 i = 0; i < countPerThread; ++i)
+					{
+						alloc.deallocate(blocks[other * countPerThread + i]);
+					}
+					return u64(0);
+				});
+			});
+		}
+
+		mallocator.deallocate(arena);
+	}
+
+	void benchmarkContainers(u32 rounds)
+	{
+		const u32 count = 16384;
+
+		runBenchmark("DynamicArray<u32> push_back", rounds, count, [&]()
+		{
+			vx::DynamicArray<u32> arr;
+			for (u32 i = 0; i < count; ++i)
+			{
+				arr.push_back(i);
+			}
+			g_sink += arr.size();
+		});
+
+		runBenchmark("DynamicArray<u32> reserve+push_back", rounds, count, [&]()
+		{
+			vx::DynamicArray<u32> arr;
+			arr.reserve(count);
+			for (u32 i = 0; i < count; ++i)
+			{
+				arr.push_back(i);
+			}
+			g_sink += arr.size();
+		});
+
+		runBenchmark("DynamicArray<u32, GrowthPolicyFactor15> push_back", rounds, count, [&]()
+		{
+			vx::DynamicArray<u32, vx::Mallocator, vx::GrowthPolicyFactor15> arr;
+			for (u32 i = 0; i < count; ++i)
+			{
+				arr.push_back(i);
+			}
+			g_sink += arr.size();
+		});
+
+		runBenchmark("DynamicArray<std::string> push_back", rounds, count, [&]()
+		{
+			vx::DynamicArray<std::string> arr;
+			for (u32 i = 0; i < count; ++i)
+			{
+				arr.push_back("0123456789abcdefghijklmnopqrstuvwxyz");
+			}
+			g_sink += arr.size();
+		});
+
+		{
+			vx::Mallocator mallocator;
+			auto arena = mallocator.allocate(count * sizeof(u32) * 4, 64);
+			vx::LinearAllocator linear(arena);
+
+			// the array is the last allocation, every growth step expands in place
+			runBenchmark("DynamicArray<u32, LinearAllocator> expand in place", rounds, count, [&]()
+			{
+				{
+					vx::DynamicArray<u32, vx::DelegateAllocator<vx::LinearAllocator>> arr{ vx::DelegateAllocator<vx::LinearAllocator>(&linear) };
+					for (u32 i = 0; i < count; ++i)
+					{
+						arr.push_back(i);
+					}
+					g_sink += arr.size();
+				}
+				linear.deallocateAll();
+			});
+
+			linear.release();
+			mallocator.deallocate(arena);
+		}
+
+		{
+			vx::Mallocator mallocator;
+			auto arena = mallocator.allocate(count * sizeof(u32) * 4, 64);
+			vx::AllocatorResource<vx::LinearAllocator> resource(arena);
+
+			runBenchmark("std::pmr::vector<u32> LinearAllocator", rounds, count, [&]()
+			{
+				{
+					std::pmr::vector<u32> arr(&resource);
+					for (u32 i = 0; i < count; ++i)
+					{
+						arr.push_back(i);
+					}
+					g_sink += arr.size();
+				}
+				resource.getAllocator().deallocateAll();
+			});
+
+			runBenchmark("DynamicArray<u32, PmrAllocator> push_back", rounds, count, [&]()
+			{
+				{
+					vx::DynamicArray<u32, vx::PmrAllocator> arr{ vx::PmrAllocator(&resource) };
+					for (u32 i = 0; i < count; ++i)
+					{
+						arr.push_back(i);
+					}
+					g_sink += arr.size();
+				}
+				resource.getAllocator().deallocateAll();
+			});
+
+			resource.getAllocator().release();
+			mallocator.deallocate(arena);
+		}
+
+		runBenchmark("DynamicArray<u32> reserve", rounds, 1, [&]()
+		{
+			vx::DynamicArray<u32> arr;
+			arr.reserve(count);
+			g_sink += arr.capacity();
+		});
+
+		{
+			const u32 bigCount = 4 * 1024 * 1024;
+			runBenchmark("DynamicArray<u32> resize 4M", rounds / 10 + 1, bigCount, [&]()
+			{
+				vx::DynamicArray<u32> arr;
+				arr.resize(bigCount);
+				g_sink += arr[bigCount - 1] + arr.size();
+			});
+
+			runBenchmark("DynamicArray<u32> erase front 4M", rounds / 10 + 1, 16, [&]()
+			{
+				vx::DynamicArray<u32> arr;
+				arr.resize(bigCount);
+				for (u32 i = 0; i < 16; ++i)
+				{
+					arr.erase(arr.begin());
+				}
+				g_sink += arr.size();
+			});
+		}
+
+		{
+			struct Record { u64 data[8]; };
+			const u32 recordCount = 256 * 1024;
+
+			runBenchmark("DynamicArray<Record> push_back 256K", rounds / 10 + 1, recordCount, [&]()
+			{
+				vx::DynamicArray<Record> arr;
+				for (u32 i = 0; i < recordCount; ++i)
+				{
+					arr.push_back(Record{ { i } });
+				}
+				g_sink += arr.size();
+			});
+
+			runBenchmark("SegmentedArray<Record, 1024> push_back 256K", rounds / 10 + 1, recordCount, [&]()
+			{
+				vx::SegmentedArray<Record, 1024> arr;
+				for (u32 i = 0; i < recordCount; ++i)
+				{
+					arr.push_back(Record{ { i } });
+				}
+				g_sink += arr.size();
+			});
+		}
+
+		{
+			vx::SpscRing<u64> spsc;
+			vx::MpmcRing<u64> mpmc;
+			spsc.initialize(1024);
+			mpmc.initialize(1024);
+
+			runBenchmark("SpscRing<u64> push/pop", rounds, count, [&]()
+			{
+				u64 value = 0;
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_failed += !spsc.push(i);
+					g_failed += !spsc.pop(&value);
+				}
+				g_sink += value;
+			});
+
+			runBenchmark("MpmcRing<u64> push/pop", rounds, count, [&]()
+			{
+				u64 value = 0;
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_failed += !mpmc.push(i);
+					g_failed += !mpmc.pop(&value);
+				}
+				g_sink += value;
+			});
+
+			runBenchmark("MpmcRing<u64> push_n/pop_n 64", rounds, count, [&]()
+			{
+				u64 values[64];
+				for (u32 i = 0; i < count; i += 64)
+				{
+					g_failed += 64 - mpmc.push_n(values, 64);
+					g_failed += 64 - mpmc.pop_n(values, 64);
+				}
+				g_sink += values[63];
+			});
+
+			// one producer thread, one consumer thread
+			runBenchmark("SpscRing<u64> 2 threads push_n/pop_n 64", rounds, count, [&]()
+			{
+				runThreads(2, [&](u32 thread)
+				{
+					u64 values[64] = {};
+					u32 done = 0;
+					while (done < count)
+					{
+						auto n = (thread == 0) ? spsc.push_n(values, 64) : spsc.pop_n(values, 64);
+						if (n == 0)
+						{
+							std::this_thread::yield();
+						}
+						done += (u32)n;
+					}
+					return u64(0);
+				});
+			});
+		}
+
+		{
+			const char* paths[] =
+			{
+				"textures/terrain/grass_01.png",
+				"meshes/props/barrel.mesh",
+				"fonts/verdana_32.font",
+				"shaders/forward_lit.glsl"
+			};
+
+			runBenchmark("String construct 20-30 chars", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					vx::String str(paths[i & 3]);
+					g_sink += str.size();
+				}
+			});
+
+			vx::String haystack("assets/levels/forest/chunks/chunk_0042/terrain/layers/grass_overlay_01.texture");
+			vx::String upper("ASSETS/LEVELS/FOREST/CHUNKS/CHUNK_0042/TERRAIN/LAYERS/GRASS_OVERLAY_01.TEXTURE");
+
+			runBenchmark("String find", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_sink += haystack.find("overlay");
+				}
+			});
+
+			runBenchmark("String compareIgnoreCase 80 chars", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_sink += haystack.compareIgnoreCase(upper);
+				}
+			});
+		}
+
+		runBenchmark("InplaceArray<u32, 64> push_back", rounds, count, [&]()
+		{
+			vx::InplaceArray<u32, 64> arr;
+			for (u32 i = 0; i < count; ++i)
+			{
+				arr.push_back(i);
+			}
+			g_sink += arr.size();
+		});
+
+		runBenchmark("InplaceArray<u32, 64> push_back inplace", rounds, 64, [&]()
+		{
+			vx::InplaceArray<u32, 64> arr;
+			for (u32 i = 0; i < 64; ++i)
+			{
+				arr.push_back(i);
+			}
+			g_sink += arr.size();
+		});
+
+		runBenchmark("InplaceArray<u32, 64> reserve", rounds, 1, [&]()
+		{
+			vx::InplaceArray<u32, 64> arr;
+			arr.reserve(count);
+			g_sink += arr.capacity();
+		});
+
+		{
+			std::unique_ptr<vx::StringID[]> keys(new vx::StringID[count]);
+			for (u32 i = 0; i < count; ++i)
+			{
+				char name[32];
+				auto size = snprintf(name, sizeof(name), "resource_%u", i);
+				keys[i] = vx::make_sid(name, (u32)size);
+			}
+
+			vx::SortedArray<vx::StringID, u32, vx::Mallocator> sortedArray(vx::Mallocator(), count);
+			vx::HashMap<vx::StringID, u32> hashMap;
+			for (u32 i = 0; i < count; ++i)
+			{
+				sortedArray.insert(keys[i], i);
+				hashMap.insert(keys[i], i);
+			}
+
+			runBenchmark("SortedArray<StringID, u32> find", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_sink += *sortedArray.find(keys[(i * 7919) % count]);
+				}
+			});
+
+			runBenchmark("HashMap<StringID, u32> find", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_sink += *hashMap.find(keys[(i * 7919) % count]);
+				}
+			});
+
+			sortedArray.build_search_index();
+			runBenchmark("SortedArray<StringID, u32> find eytzinger", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_sink += *sortedArray.find(keys[(i * 7919) % count]);
+				}
+			});
+
+			std::unique_ptr<u32*[]> results(new u32*[count]);
+			runBenchmark("SortedArray<StringID, u32> find_batch", rounds, count, [&]()
+			{
+				sortedArray.find_batch(keys.get(), count, results.get());
+				g_sink += *results[count - 1];
+			});
+
+			std::unique_ptr<u32[]> values(new u32[count]);
+			for (u32 i = 0; i < count; ++i)
+			{
+				values[i] = i;
+			}
+
+			runBenchmark("SortedArray<StringID, u32> insert", 1, count, [&]()
+			{
+				vx::SortedArray<vx::StringID, u32, vx::Mallocator> arr;
+				for (u32 i = 0; i < count; ++i)
+				{
+					arr.insert(keys[i], i);
+				}
+				g_sink += arr.size();
+			});
+
+			runBenchmark("SortedArray<StringID, u32> insert_range", rounds, count, [&]()
+			{
+				vx::SortedArray<vx::StringID, u32, vx::Mallocator> arr;
+				g_sink += arr.insert_range(keys.get(), values.get(), count);
+			});
+
+			runBenchmark("HashMap<StringID, u32> insert", rounds, count, [&]()
+			{
+				vx::HashMap<vx::StringID, u32> map;
+				for (u32 i = 0; i < count; ++i)
+				{
+					map.insert(keys[i], i);
+				}
+				g_sink += map.size();
+			});
+		}
+
+		{
+			// larger than L2, where the flat binary search misses on every level
+			const u32 bigCount = 1 << 20;
+			std::unique_ptr<u64[]> keys(new u64[bigCount]);
+			std::unique_ptr<u64[]> queries(new u64[count]);
+			for (u32 i = 0; i < bigCount; ++i)
+			{
+				keys[i] = (u64)i * 2654435761u;
+			}
+			for (u32 i = 0; i < count; ++i)
+			{
+				queries[i] = keys[(i * 7919u) % bigCount];
+			}
+
+			vx::SortedArray<u64, u64, vx::Mallocator> arr;
+			arr.build_from_unsorted(keys.get(), keys.get(), bigCount);
+
+			runBenchmark("SortedArray<u64, u64> 1M find", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_sink += *arr.find(queries[i]);
+				}
+			});
+
+			arr.build_search_index();
+			runBenchmark("SortedArray<u64, u64> 1M find eytzinger", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_sink += *arr.find(queries[i]);
+				}
+			});
+
+			std::unique_ptr<u64*[]> results(new u64*[count]);
+			runBenchmark("SortedArray<u64, u64> 1M find_batch", rounds, count, [&]()
+			{
+				arr.find_batch(queries.get(), count, results.get());
+				g_sink += *results[count - 1];
+			});
+		}
+
+		{
+			// 56 byte vertex, the update only reads and writes the position
+			struct Vertex
+			{
+				f32 position[3];
+				f32 normal[3];
+				f32 tangent[3];
+				f32 uv[2];
+				u32 color;
+				u32 boneIndex;
+				u32 boneWeight;
+			};
+
+			const u32 vertexCount = 1 << 18;
+			std::unique_ptr<Vertex[]> aos(new Vertex[vertexCount]());
+
+			vx::SoaArray<vx::Mallocator, f32, f32, f32, vx::float3, vx::float3, vx::float2, u32> soa(vx::Mallocator(), vertexCount);
+			for (u32 i = 0; i < vertexCount; ++i)
+			{
+				soa.push_back(0.0f, 0.0f, 0.0f, vx::float3(0.0f), vx::float3(0.0f), vx::float2(0.0f), 0);
+			}
+
+			runBenchmark("AoS<56 byte vertex> translate", rounds, vertexCount, [&]()
+			{
+				for (u32 i = 0; i < vertexCount; ++i)
+				{
+					aos[i].position[0] += 1.0f;
+					aos[i].position[1] += 2.0f;
+					aos[i].position[2] += 3.0f;
+				}
+				g_sink += (size_t)aos[vertexCount - 1].position[0];
+			});
+
+			runBenchmark("SoaArray<vertex> translate", rounds, vertexCount, [&]()
+			{
+				auto x = soa.span<0>();
+				auto y = soa.span<1>();
+				auto z = soa.span<2>();
+				for (u32 i = 0; i < vertexCount; ++i)
+				{
+					x[i] += 1.0f;
+					y[i] += 2.0f;
+					z[i] += 3.0f;
+				}
+				g_sink += (size_t)x[vertexCount - 1];
+			});
+		}
+
+		{
+			std::unique_ptr<vx::ObjectPoolHandle[]> handles(new vx::ObjectPoolHandle[count]);
+			vx::ObjectPool<u32> pool;
+
+			runBenchmark("ObjectPool<u32> create/destroy", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					handles[i] = pool.create(i);
+				}
+
+				for (u32 i = 0; i < count; ++i)
+				{
+					pool.destroy(handles[(i * 7) % count]);
+				}
+			});
+
+			for (u32 i = 0; i < count; ++i)
+			{
+				handles[i] = pool.create(i);
+			}
+
+			runBenchmark("ObjectPool<u32> get", rounds, count, [&]()
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					g_sink += *pool.get(handles[i]);
+				}
+			});
+
+			runBenchmark("ObjectPool<u32> forEachChunk", rounds, count, [&]()
+			{
+				u32 sum = 0;
+				pool.forEachChunk([&](u32* objects, u32 n)
+				{
+					for (u32 i = 0; i < n; ++i)
+					{
+						sum += objects[i];
+					}
+				});
+				g_sink += sum;
+			});
+		}
+	}
+
+	void benchmarkJobSystem(u32 rounds)
+	{
+		vx::JobSystem jobSystem;
+		if (!jobSystem.initialize(0))
+		{
+			++g_failed;
+			return;
+		}
+
+		const u32 jobCount = 1024;
+		runBenchmark("JobSystem run/wait empty jobs", rounds, jobCount, [&]()
+		{
+			vx::JobCounter counter;
+			for (u32 i = 0; i < jobCount; ++i)
+			{
+				jobSystem.run([]() {}, &counter);
+			}
+			jobSystem.wait(&counter);
+			jobSystem.resetFrame();
+		});
+
+		const u32 count = 1024 * 1024;
+		vx::DynamicArray<u32> values;
+		values.resize(count);
+
+		runBenchmark("serial for 1M u32", rounds, count, [&]()
+		{
+			for (u32 i = 0; i < count; ++i)
+			{
+				values[i] = values[i] * 3 + i;
+			}
+			g_sink += values[count - 1];
+		});
+
+		runBenchmark("JobSystem parallel_for 1M u32 grain 16K", rounds, count, [&]()
+		{
+			jobSystem.parallel_for(values, 16 * 1024, [](u32* first, u32* last)
+			{
+				for (auto p = first; p != last; ++p)
+				{
+					*p = *p * 3 + (u32)(p - first);
+				}
+			});
+			jobSystem.resetFrame();
+			g_sink += values[count - 1];
+		});
+
+		jobSystem.shutdown();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	u32 rounds = 200;
+	if (argc > 1)
+	{
+		rounds = (u32)strtoul(argv[1], nullptr, 10);
+	}
+
+	benchmarkAllocators(rounds);
+	benchmarkSharedAllocators(rounds);
+	benchmarkContainers(rounds);
+	benchmarkJobSystem(rounds);
+
+	return 0;
+}
@@ -26,7 +26,12 @@ SOFTWARE.
 
 #include <vxLib/types.h>
 #include <malloc.h>
+#include <cstring>
+#ifndef _VX_PLATFORM_WINDOWS
+#include <mm_malloc.h>
+#endif
 #include <utility>
+#include <type_traits>
 
 namespace vx
 {
@@ -121,6 +126,37 @@ namespace vx
 		virtual bool contains(const AllocatedBlock block) const = 0;
 	};
 
+	namespace detail
+	{
+		template<typename Allocator, typename = void>
+		struct HasExpandInPlace : std::false_type {};
+
+		template<typename Allocator>
+		struct HasExpandInPlace<Allocator, decltype((void)std::declval<Allocator&>().try_expand_in_place(AllocatedBlock(), 0, 0))> : std::true_type {};
+
+		template<typename Allocator>
+		AllocatedBlock tryExpandInPlace(Allocator &allocator, const AllocatedBlock block, size_t size, size_t alignment, std::true_type)
+		{
+			return allocator.try_expand_in_place(block, size, alignment);
+		}
+
+		template<typename Allocator>
+		AllocatedBlock tryExpandInPlace(Allocator&, const AllocatedBlock, size_t, size_t, std::false_type)
+		{
+			return{ nullptr, 0 };
+		}
+	}
+
+	/*
+	optional allocator hook: try_expand_in_place(block, size, alignment) resizes block without moving it
+	or returns {nullptr, 0}. Allocators without the hook always fail.
+	*/
+	template<typename Allocator>
+	AllocatedBlock tryExpandInPlace(Allocator &allocator, const AllocatedBlock block, size_t size, size_t alignment)
+	{
+		return detail::tryExpandInPlace(allocator, block, size, alignment, detail::HasExpandInPlace<Allocator>());
+	}
+
 	typedef vx::AllocatedBlock(*AllocationCallbackSignature)(size_t size, size_t alignment);
 	typedef u32 (*DeallocationCallbackSignature)(const vx::AllocatedBlock block);
 }
\ No newline at end of file
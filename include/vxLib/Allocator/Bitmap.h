@@ -0,0 +1,347 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/util/bitops.h>
+#include <cstring>
+#ifdef __AVX2__
+#include <immintrin.h>
+#define _VX_BITMAP_AVX2 1
+#endif
+
+namespace vx
+{
+	struct BitmapRunStats
+	{
+		size_t freeBits;
+		size_t runCount;
+		size_t largestRun;
+	};
+
+	/*
+	bitmap over externally owned memory, a set bit marks a free block.
+	A summary level keeps one bit per 64 bit word that is set while the word has any free bit,
+	so searches skip a fully used 64 * 64 block region with a single test.
+	Bitmaps with a single word are stored inline.
+	*/
+	class Bitmap
+	{
+		enum : size_t { BitsWord = 64 };
+
+		union
+		{
+			u64* m_words;
+			u64 m_inlineWord;
+		};
+		u64* m_summary;
+		size_t m_bitCount;
+		size_t m_wordCount;
+		size_t m_summaryCount;
+		u64 m_inlineSummary;
+
+		u64* getWords() { return (m_wordCount <= 1) ? &m_inlineWord : m_words; }
+		const u64* getWords() const { return (m_wordCount <= 1) ? &m_inlineWord : m_words; }
+		u64* getSummary() { return (m_wordCount <= 1) ? &m_inlineSummary : m_summary; }
+
+		static u64 getMask(size_t bit, size_t count)
+		{
+			return ((count >= BitsWord) ? ~u64(0) : ((u64(1) << count) - 1)) << bit;
+		}
+
+		// bit i of the result is set if bits i..i+count-1 of x are set
+		static u64 findRuns(u64 x, size_t count)
+		{
+			while (count > 1)
+			{
+				auto s = count >> 1;
+				x = x & (x >> s);
+				count = count - s;
+			}
+
+			return x;
+		}
+
+		// index of the first non zero word in [first, last), last if there is none
+		static size_t findNonZeroWord(const u64* words, size_t first, size_t last)
+		{
+#if _VX_BITMAP_AVX2
+			while (first + 4 <= last)
+			{
+				auto v = _mm256_loadu_si256((const __m256i*)(words + first));
+				if (!_mm256_testz_si256(v, v))
+					break;
+
+				first += 4;
+			}
+#endif
+			while (first < last && words[first] == 0)
+			{
+				++first;
+			}
+
+			return first;
+		}
+
+		void updateSummary(size_t wordIndex, u64 word)
+		{
+			auto summary = getSummary();
+			auto bit = u64(1) << (wordIndex & (BitsWord - 1));
+			if (word != 0)
+				summary[wordIndex / BitsWord] |= bit;
+			else
+				summary[wordIndex / BitsWord] &= ~bit;
+		}
+
+		template<typename F>
+		void forEachWord(size_t index, size_t count, F &&f)
+		{
+			auto words = getWords();
+			while (count > 0)
+			{
+				auto wordIndex = index / BitsWord;
+				auto bit = index & (BitsWord - 1);
+				auto bits = (count < BitsWord - bit) ? count : BitsWord - bit;
+
+				words[wordIndex] = f(words[wordIndex], getMask(bit, bits));
+				updateSummary(wordIndex, words[wordIndex]);
+
+				index += bits;
+				count -= bits;
+			}
+		}
+
+	public:
+		Bitmap() :m_words(nullptr), m_summary(nullptr), m_bitCount(0), m_wordCount(0), m_summaryCount(0), m_inlineSummary(0) {}
+
+		static size_t getWordCount(size_t bitCount)
+		{
+			return (bitCount + BitsWord - 1) / BitsWord;
+		}
+
+		// bytes needed for the external storage, zero for bitmaps that fit inline
+		static size_t getRequiredBytes(size_t bitCount)
+		{
+			auto wordCount = getWordCount(bitCount);
+			if (wordCount <= 1)
+				return 0;
+
+			return (wordCount + getWordCount(wordCount)) * sizeof(u64);
+		}
+
+		// memory needs getRequiredBytes(bitCount) bytes aligned to 8, all bits start out set
+		void initialize(void* memory, size_t bitCount)
+		{
+			m_bitCount = bitCount;
+			m_wordCount = getWordCount(bitCount);
+			m_summaryCount = getWordCount(m_wordCount);
+			if (m_wordCount > 1)
+			{
+				m_words = (u64*)memory;
+				m_summary = m_words + m_wordCount;
+			}
+
+			setAll();
+		}
+
+		void release()
+		{
+			m_words = nullptr;
+			m_summary = nullptr;
+			m_bitCount = m_wordCount = m_summaryCount = 0;
+			m_inlineSummary = 0;
+		}
+
+		void setAll()
+		{
+			if (m_wordCount == 0)
+				return;
+
+			auto words = getWords();
+			auto summary = getSummary();
+			::memset(words, 0xff, m_wordCount * sizeof(u64));
+			::memset(summary, 0, m_summaryCount * sizeof(u64));
+
+			auto tail = m_bitCount & (BitsWord - 1);
+			if (tail != 0)
+				words[m_wordCount - 1] = getMask(0, tail);
+
+			for (size_t i = 0; i < m_wordCount; ++i)
+			{
+				summary[i / BitsWord] |= u64(1) << (i & (BitsWord - 1));
+			}
+		}
+
+		// marks [index, index + count) as free
+		void setRange(size_t index, size_t count)
+		{
+			forEachWord(index, count, [](u64 word, u64 mask) { return word | mask; });
+		}
+
+		// marks [index, index + count) as used
+		void clearRange(size_t index, size_t count)
+		{
+			forEachWord(index, count, [](u64 word, u64 mask) { return word & ~mask; });
+		}
+
+		bool isRangeSet(size_t index, size_t count) const
+		{
+			if (index + count > m_bitCount)
+				return false;
+
+			auto words = getWords();
+			while (count > 0)
+			{
+				auto wordIndex = index / BitsWord;
+				auto bit = index & (BitsWord - 1);
+				auto bits = (count < BitsWord - bit) ? count : BitsWord - bit;
+
+				auto mask = getMask(bit, bits);
+				if ((words[wordIndex] & mask) != mask)
+					return false;
+
+				index += bits;
+				count -= bits;
+			}
+
+			return true;
+		}
+
+		// first fit search for count consecutive set bits
+		bool findRun(size_t count, size_t* resultBit)
+		{
+			if (count == 0 || count > m_bitCount)
+				return false;
+
+			auto words = getWords();
+			auto summary = getSummary();
+
+			// free bits at the top of the previous word, only valid while words are adjacent
+			size_t carry = 0;
+			size_t carryStart = 0;
+			size_t lastWord = size_t(-1);
+
+			size_t summaryIndex = 0;
+			while ((summaryIndex = findNonZeroWord(summary, summaryIndex, m_summaryCount)) < m_summaryCount)
+			{
+				auto summaryBits = summary[summaryIndex];
+				while (summaryBits != 0)
+				{
+					auto wordIndex = summaryIndex * BitsWord + ntz64(summaryBits);
+					summaryBits &= summaryBits - 1;
+
+					auto word = words[wordIndex];
+					if (wordIndex != lastWord + 1)
+						carry = 0;
+					lastWord = wordIndex;
+
+					if (carry != 0)
+					{
+						auto lowFree = (word == ~u64(0)) ? (size_t)BitsWord : ntz64(~word);
+						if (carry + lowFree >= count)
+						{
+							*resultBit = carryStart;
+							return true;
+						}
+
+						if (word == ~u64(0))
+						{
+							carry += BitsWord;
+							continue;
+						}
+					}
+
+					if (count <= BitsWord)
+					{
+						auto runs = findRuns(word, count);
+						if (runs != 0)
+						{
+							*resultBit = wordIndex * BitsWord + ntz64(runs);
+							return true;
+						}
+					}
+
+					carry = (word == ~u64(0)) ? (size_t)BitsWord : nlz64(~word);
+					carryStart = wordIndex * BitsWord + BitsWord - carry;
+				}
+
+				++summaryIndex;
+			}
+
+			return false;
+		}
+
+		bool findFirst(size_t* resultBit)
+		{
+			auto summary = getSummary();
+			auto summaryIndex = findNonZeroWord(summary, 0, m_summaryCount);
+			if (summaryIndex == m_summaryCount)
+				return false;
+
+			auto wordIndex = summaryIndex * BitsWord + ntz64(summary[summaryIndex]);
+			*resultBit = wordIndex * BitsWord + ntz64(getWords()[wordIndex]);
+			return true;
+		}
+
+		// walks every word, meant for fragmentation reports and not for the allocation path
+		BitmapRunStats getRunStats() const
+		{
+			BitmapRunStats stats = { 0, 0, 0 };
+
+			auto words = getWords();
+			size_t run = 0;
+			for (size_t i = 0; i < m_wordCount; ++i)
+			{
+				auto word = words[i];
+				size_t bit = 0;
+				while (bit < BitsWord)
+				{
+					auto rest = word >> bit;
+					auto zeros = (rest == 0) ? BitsWord - bit : ntz64(rest);
+					if (zeros != 0)
+					{
+						stats.largestRun = (run > stats.largestRun) ? run : stats.largestRun;
+						run = 0;
+						bit += zeros;
+						continue;
+					}
+
+					// ~rest has the bits shifted in at the top set, so the run ends at the word boundary
+					auto ones = (~rest == 0) ? (size_t)BitsWord : ntz64(~rest);
+					if (run == 0)
+						++stats.runCount;
+
+					run += ones;
+					stats.freeBits += ones;
+					bit += ones;
+				}
+			}
+			stats.largestRun = (run > stats.largestRun) ? run : stats.largestRun;
+
+			return stats;
+		}
+
+		size_t size() const { return m_bitCount; }
+	};
+}
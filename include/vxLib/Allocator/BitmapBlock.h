@@ -25,7 +25,7 @@ SOFTWARE.
 */
 
 #include <vxLib/Allocator/StackAllocator.h>
-#include <intrin.h>
+#include <vxLib/Allocator/Bitmap.h>
 
 namespace vx
 {
@@ -38,29 +38,20 @@ namespace vx
 
 		enum : size_t
 		{
-			BitsSizeT = sizeof(size_t) * 8,
-			ClassDataSize = sizeof(u8*) * 2 + sizeof(size_t) * 2,
+			ClassDataSize = sizeof(u8*) + sizeof(Bitmap) + sizeof(size_t) * 2,
 			ClassAlignment = __alignof(Super),
 			ClassAlignedDataSize = GetAlignedSize<ClassDataSize, ClassAlignment>::size,
-			PaddingSize = ClassAlignedDataSize - ClassDataSize
+			PaddingSize = ClassAlignedDataSize - ClassDataSize,
+			BitsAlignment = (ALIGNMENT < __alignof(u64)) ? __alignof(u64) : ALIGNMENT
 		};
 
 		u8* m_firstBlock;
-		union
-		{
-			u32* m_bitsPtr;
-			size_t m_bits;
-		};
+		Bitmap m_bitmap;
 		size_t m_remainingBlocks;
 		size_t m_blockCount;
 		Padding<PaddingSize> m_padding;
 		Super m_parent;
 
-		u32* getBitsPtr()
-		{
-			return (m_blockCount <= BitsSizeT) ? (u32*)&m_bits : m_bitsPtr;
-		}
-
 		size_t countBlocks()
 		{
 			size_t blockCount = 0;
@@ -77,77 +68,32 @@ namespace vx
 			return blockCount;
 		}
 
-		bool findEmptyBit(u32* bitPtr, size_t* resultBit)
-		{
-			size_t block = 0;
-			auto remainingBlocks = m_blockCount;
-			while (remainingBlocks > 0)
-			{
-				auto bitsToCheck = (remainingBlocks < 32) ? remainingBlocks : 32;
-
-				auto p = *bitPtr++;
-				unsigned long bit = 0;
-				auto result = _BitScanForward(&bit, p);
-				if (result != 0)
-				{
-					*resultBit = block + bit;
-
-					return bit < bitsToCheck;
-				}
-
-				block += 32;
-				remainingBlocks -= bitsToCheck;
-			}
-
-			return false;
-		}
-
-		void setBit(size_t blockIndex)
-		{
-			auto bitPtr = getBitsPtr();
-
-			auto byte = blockIndex / 32;
-			auto bit = blockIndex & 31;
-
-			bitPtr[byte] |= (1 << bit);
-		}
-
-		void clearBit(u32* bitPtr, size_t blockIndex)
-		{
-			auto byte = blockIndex / 32;
-			auto bit = blockIndex & 31;
-
-			bitPtr[byte] &= ~(1 << bit);
-		}
-
 		void initializeImpl()
 		{
 			auto blockCount = countBlocks();
 			if (blockCount == 0)
 				return;
 
-			if (blockCount <= BitsSizeT)
+			u8* bitsPtr = nullptr;
+			auto requiredBytes = Bitmap::getRequiredBytes(blockCount);
+			if (requiredBytes != 0)
 			{
-				// small string optimization
-				m_bits = size_t(-1);
-			}
-			else
-			{
-				auto requiredBytes = vx::getAlignedSize(blockCount * sizeof(u32), __alignof(u32));
 				auto requiredBlocksForBits = (requiredBytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
-
 				if (blockCount <= requiredBlocksForBits)
 					return;
 
 				blockCount -= requiredBlocksForBits;
 
-				auto bitBlock = m_parent.allocate(BLOCK_SIZE * requiredBlocksForBits, ALIGNMENT);
-				m_bitsPtr = (u32*)bitBlock.ptr;
-				std::memset(m_bitsPtr, 0xff, bitBlock.size);
+				bitsPtr = m_parent.allocate(BLOCK_SIZE * requiredBlocksForBits, BitsAlignment).ptr;
+				if (bitsPtr == nullptr)
+					return;
 			}
 
 			m_firstBlock = m_parent.allocate(BLOCK_SIZE * blockCount, ALIGNMENT).ptr;
+			if (m_firstBlock == nullptr)
+				return;
 
+			m_bitmap.initialize(bitsPtr, blockCount);
 			m_remainingBlocks = blockCount;
 			m_blockCount = blockCount;
 		}
@@ -155,9 +101,9 @@ namespace vx
 	public:
 		enum : size_t { BlockSize = BLOCK_SIZE, Alignment = ALIGNMENT };
 
-		BitmapBlock() : m_firstBlock(nullptr), m_bitsPtr(nullptr), m_remainingBlocks(0), m_blockCount(0), m_parent() { initializeImpl(); }
+		BitmapBlock() : m_firstBlock(nullptr), m_bitmap(), m_remainingBlocks(0), m_blockCount(0), m_parent() { initializeImpl(); }
 
-		explicit BitmapBlock(const AllocatedBlock block) : m_firstBlock(nullptr), m_bitsPtr(nullptr), m_remainingBlocks(0), m_blockCount(0), m_parent(block) { initializeImpl(); }
+		explicit BitmapBlock(const AllocatedBlock block) : m_firstBlock(nullptr), m_bitmap(), m_remainingBlocks(0), m_blockCount(0), m_parent(block) { initializeImpl(); }
 
 		~BitmapBlock() {}
 
@@ -171,7 +117,7 @@ namespace vx
 		AllocatedBlock release()
 		{
 			m_firstBlock = nullptr;
-			m_bitsPtr = nullptr;
+			m_bitmap.release();
 			m_remainingBlocks = m_blockCount = 0;
 			return m_parent.release();
 		}
@@ -184,14 +130,12 @@ namespace vx
 			}
 
 			size_t blockIndex = 0;
-
-			auto bitPtr = getBitsPtr();
-			if (!findEmptyBit(bitPtr, &blockIndex))
+			if (!m_bitmap.findFirst(&blockIndex))
 			{
 				return{ nullptr, 0 };
 			}
 
-			clearBit(bitPtr, blockIndex);
+			m_bitmap.clearRange(blockIndex, 1);
 			auto offset = blockIndex * BLOCK_SIZE;
 			--m_remainingBlocks;
 
@@ -214,7 +158,7 @@ namespace vx
 			}
 
 			auto blockIndex = (block.ptr - m_firstBlock) / BLOCK_SIZE;
-			setBit(blockIndex);
+			m_bitmap.setRange(blockIndex, 1);
 
 			++m_remainingBlocks;
 
@@ -223,7 +167,8 @@ namespace vx
 
 		void deallocateAll()
 		{
-			m_parent.deallocateAll();
+			m_bitmap.setAll();
+			m_remainingBlocks = m_blockCount;
 		}
 
 		bool contains(const AllocatedBlock block) const
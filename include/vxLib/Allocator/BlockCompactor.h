@@ -0,0 +1,233 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Bitmap.h>
+#include <vxLib/Container/ObjectPool.h>
+#include <vxLib/Container/DynamicArray.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace vx
+{
+	namespace detail
+	{
+		inline size_t getBlockAddress(const AllocatedBlock &block) { return (size_t)block.ptr; }
+		inline size_t getBlockAddress(const GpuAllocatedBlock &block) { return block.offset; }
+
+		inline bool isBlockValid(const AllocatedBlock &block) { return block.ptr != nullptr && block.size != 0; }
+		inline bool isBlockValid(const GpuAllocatedBlock &block) { return block.size != 0; }
+	}
+
+	// moves host memory and frees the old block right away
+	struct HostBlockMover
+	{
+		void move(const AllocatedBlock &dst, const AllocatedBlock &src)
+		{
+			::memcpy(dst.ptr, src.ptr, src.size);
+		}
+
+		template<typename Heap>
+		void release(Heap* heap, const AllocatedBlock &src)
+		{
+			heap->deallocate(src);
+		}
+	};
+
+	/*
+	incremental compaction for first fit block heaps like MultiBlockAllocator and GpuMultiBlockAllocator.
+	Allocations that can move are registered and only referenced through handles, get(handle) is valid until the next step.
+	plan orders the movable allocations from the highest address down, step moves each one into the lowest free run
+	that fits below it until the byte budget of the slice is used up, so the top of the heap drains into the holes.
+	Allocations that are not registered or are pinned stay where they are.
+
+	Mover needs move(dst, src) to copy the contents and release(heap, src) to free the old block.
+	For offset heaps move can record a copy command and release can use deallocate(src, fence).
+	*/
+	template<typename Heap, typename Mover = HostBlockMover>
+	class BlockCompactor
+	{
+	public:
+		typedef decltype(std::declval<Heap&>().allocate(0, 0)) Block;
+		typedef ObjectPoolHandle Handle;
+
+	private:
+		struct Entry
+		{
+			Block block;
+			u32 alignment;
+			u32 pinCount;
+		};
+
+		Heap* m_heap;
+		ObjectPool<Entry> m_entries;
+		DynamicArray<Handle> m_plan;
+		u32 m_planPosition;
+		Mover m_mover;
+
+		bool moveEntry(Entry* entry)
+		{
+			auto newBlock = m_heap->allocate(entry->block.size, entry->alignment);
+			if (!detail::isBlockValid(newBlock))
+				return false;
+
+			if (detail::getBlockAddress(newBlock) > detail::getBlockAddress(entry->block))
+			{
+				m_heap->deallocate(newBlock);
+				return false;
+			}
+
+			m_mover.move(newBlock, entry->block);
+			m_mover.release(m_heap, entry->block);
+			entry->block = newBlock;
+
+			return true;
+		}
+
+	public:
+		BlockCompactor() :m_heap(nullptr), m_entries(), m_plan(), m_planPosition(0), m_mover() {}
+
+		explicit BlockCompactor(Heap* heap, Mover &&mover = Mover()) :m_heap(heap), m_entries(), m_plan(), m_planPosition(0), m_mover(std::move(mover)) {}
+
+		BlockCompactor(const BlockCompactor&) = delete;
+		BlockCompactor& operator=(const BlockCompactor&) = delete;
+
+		~BlockCompactor() {}
+
+		Handle allocate(size_t size, size_t alignment)
+		{
+			auto block = m_heap->allocate(size, alignment);
+			if (!detail::isBlockValid(block))
+				return Handle();
+
+			auto handle = registerBlock(block, alignment);
+			if (handle.isNull())
+				m_heap->deallocate(block);
+
+			return handle;
+		}
+
+		void deallocate(Handle handle)
+		{
+			auto block = unregisterBlock(handle);
+			if (detail::isBlockValid(block))
+				m_heap->deallocate(block);
+		}
+
+		// takes over a block allocated from the heap with alignment
+		Handle registerBlock(const Block &block, size_t alignment)
+		{
+			return m_entries.create(Entry{ block, (u32)alignment, 0 });
+		}
+
+		// the block stays allocated and will not move anymore
+		Block unregisterBlock(Handle handle)
+		{
+			auto entry = m_entries.get(handle);
+			if (entry == nullptr)
+				return Block();
+
+			auto block = entry->block;
+			m_entries.destroy(handle);
+
+			return block;
+		}
+
+		Block get(Handle handle) const
+		{
+			auto entry = m_entries.get(handle);
+			return (entry == nullptr) ? Block() : entry->block;
+		}
+
+		// pinned allocations are skipped by step, e.g. while the gpu or another thread reads them
+		void pin(Handle handle)
+		{
+			auto entry = m_entries.get(handle);
+			if (entry)
+				++entry->pinCount;
+		}
+
+		void unpin(Handle handle)
+		{
+			auto entry = m_entries.get(handle);
+			if (entry && entry->pinCount != 0)
+				--entry->pinCount;
+		}
+
+		// returns the number of planned moves
+		u32 plan()
+		{
+			m_plan.clear();
+			m_plan.reserve(m_entries.size());
+			for (u32 i = 0; i < m_entries.size(); ++i)
+			{
+				m_plan.push_back(m_entries.getHandle(i));
+			}
+
+			auto &entries = m_entries;
+			std::sort(m_plan.begin(), m_plan.end(), [&entries](const Handle &l, const Handle &r)
+			{
+				return detail::getBlockAddress(entries.get(l)->block) > detail::getBlockAddress(entries.get(r)->block);
+			});
+			m_planPosition = 0;
+
+			return (u32)m_plan.size();
+		}
+
+		/*
+		runs the plan until at least maxBytes have been moved, a slice always finishes the move it started.
+		Handles that were deallocated since plan are skipped. Returns true once the plan is done.
+		*/
+		bool step(size_t maxBytes, size_t* movedBytes = nullptr)
+		{
+			size_t bytes = 0;
+			while (m_planPosition < m_plan.size() && bytes < maxBytes)
+			{
+				auto entry = m_entries.get(m_plan[m_planPosition++]);
+				if (entry == nullptr || entry->pinCount != 0)
+					continue;
+
+				if (moveEntry(entry))
+					bytes += entry->block.size;
+			}
+
+			if (movedBytes)
+				*movedBytes = bytes;
+
+			return isDone();
+		}
+
+		bool isDone() const { return m_planPosition >= m_plan.size(); }
+
+		u32 getRemainingMoves() const { return (u32)m_plan.size() - m_planPosition; }
+
+		BitmapRunStats getFreeRunStats() const { return m_heap->getFreeRunStats(); }
+
+		u32 size() const { return m_entries.size(); }
+
+		Heap* getHeap() const { return m_heap; }
+	};
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <vxLib/util/bitops.h>
+#include <cstdio>
+
+namespace vx
+{
+	namespace detail
+	{
+		template<size_t N>
+		struct BucketizerLog2
+		{
+			enum : size_t { value = 1 + BucketizerLog2<N / 2>::value };
+		};
+
+		template<>
+		struct BucketizerLog2<1>
+		{
+			enum : size_t { value = 0 };
+		};
+
+		// sizes in (MIN + (i - 1) * STEP, MIN + i * STEP] go to bucket i, upper bounds are inclusive so
+		// a block rounded up to its bucket's upper bound maps back to the same bucket
+		template<size_t MIN, size_t MAX, size_t STEP>
+		struct BucketizerMapping
+		{
+			static_assert(MIN <= MAX, "");
+
+			enum : size_t
+			{
+				BucketCount = (MAX - MIN + STEP - 1) / STEP + 1,
+				MaxBlockSize = MIN + (BucketCount - 1) * STEP
+			};
+
+			static size_t getBucket(size_t size)
+			{
+				if (size <= MIN)
+					return 0;
+
+				return (size - MIN + STEP - 1) / STEP;
+			}
+		};
+
+		// STEP == 0: sizes in (2^(i-1) * MIN, 2^i * MIN] go to bucket i, MIN and MAX need to be powers of two
+		template<size_t MIN, size_t MAX>
+		struct BucketizerMapping<MIN, MAX, 0>
+		{
+			static_assert(MIN <= MAX, "");
+			static_assert((MIN & (MIN - 1)) == 0 && (MAX & (MAX - 1)) == 0, "");
+
+			enum : size_t
+			{
+				MinShift = BucketizerLog2<MIN>::value,
+				BucketCount = BucketizerLog2<MAX>::value - MinShift + 1,
+				MaxBlockSize = MAX
+			};
+
+			static size_t getBucket(size_t size)
+			{
+				if (size <= MIN)
+					return 0;
+
+				return (64 - nlz64(size - 1)) - MinShift;
+			}
+		};
+	}
+
+	/*
+	routes requests with a size in [MIN, MAX] to one of several Allocator instances by table index,
+	STEP > 0 gives linear size classes, STEP == 0 power of two classes.
+	When constructed from a block, the block is split evenly between the buckets and ownership is
+	resolved from the address, otherwise each bucket's contains decides, starting with the bucket the
+	size maps to.
+	*/
+	template<typename Allocator, size_t MIN, size_t MAX, size_t STEP>
+	class Bucketizer
+	{
+		typedef detail::BucketizerMapping<MIN, MAX, STEP> Mapping;
+
+	public:
+		enum : size_t { BucketCount = Mapping::BucketCount };
+
+	private:
+		Allocator m_buckets[BucketCount];
+		u8* m_begin;
+		size_t m_bucketSize;
+		AllocatedBlock m_block;
+
+		static bool isInRange(size_t size)
+		{
+			return (size >= MIN) && (size <= MAX);
+		}
+
+		// BucketCount if the block does not belong to any bucket
+		size_t findOwner(const AllocatedBlock block) const
+		{
+			if (m_begin != nullptr)
+			{
+				if (block.ptr < m_begin)
+					return BucketCount;
+
+				auto index = (size_t)(block.ptr - m_begin) / m_bucketSize;
+				return (index < BucketCount) ? index : BucketCount;
+			}
+
+			if (block.ptr == nullptr)
+				return BucketCount;
+
+			// the size only picks the bucket to ask first, the bucket's address range decides
+			if (block.size <= Mapping::MaxBlockSize)
+			{
+				auto index = Mapping::getBucket(block.size);
+				if (m_buckets[index].contains(block))
+					return index;
+			}
+
+			for (size_t i = 0; i < BucketCount; ++i)
+			{
+				if (m_buckets[i].contains(block))
+					return i;
+			}
+
+			return BucketCount;
+		}
+
+	public:
+		Bucketizer() :m_buckets(), m_begin(nullptr), m_bucketSize(0), m_block() {}
+
+		explicit Bucketizer(const AllocatedBlock block) :Bucketizer() { initialize(block); }
+
+		Bucketizer(const Bucketizer&) = delete;
+		Bucketizer& operator=(const Bucketizer&) = delete;
+
+		~Bucketizer() {}
+
+		void initialize(const AllocatedBlock block)
+		{
+			m_bucketSize = block.size / BucketCount;
+			if (m_bucketSize == 0)
+				return;
+
+			m_begin = block.ptr;
+			m_block = block;
+			for (size_t i = 0; i < BucketCount; ++i)
+			{
+				m_buckets[i].initialize({ block.ptr + i * m_bucketSize, m_bucketSize });
+			}
+		}
+
+		AllocatedBlock release()
+		{
+			for (size_t i = 0; i < BucketCount; ++i)
+			{
+				m_buckets[i].release();
+			}
+
+			auto block = m_block;
+			m_begin = nullptr;
+			m_bucketSize = 0;
+			m_block.ptr = nullptr;
+			m_block.size = 0;
+
+			return block;
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (!isInRange(size))
+				return{ nullptr, 0 };
+
+			return m_buckets[Mapping::getBucket(size)].allocate(size, alignment);
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr == nullptr)
+				return allocate(size, alignment);
+
+			if (!isInRange(size))
+				return{ nullptr, 0 };
+
+			auto owner = findOwner(block);
+			auto bucket = Mapping::getBucket(size);
+			if (owner == bucket)
+				return m_buckets[bucket].reallocate(block, size, alignment);
+
+			auto newBlock = m_buckets[bucket].allocate(size, alignment);
+			if (newBlock.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+				deallocate(block);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			auto owner = findOwner(block);
+			if (owner == BucketCount)
+				return 0;
+
+			return m_buckets[owner].deallocate(block);
+		}
+
+		void deallocateAll()
+		{
+			for (size_t i = 0; i < BucketCount; ++i)
+			{
+				m_buckets[i].deallocateAll();
+			}
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			return findOwner(block) != BucketCount;
+		}
+
+		Allocator& getBucket(size_t index) { return m_buckets[index]; }
+
+		void print() const
+		{
+			printf("buckets: %llu, min: %llu, max: %llu, step: %llu\n", (unsigned long long)BucketCount,
+				(unsigned long long)MIN, (unsigned long long)MAX, (unsigned long long)STEP);
+		}
+	};
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <new>
+
+namespace vx
+{
+	/*
+	factory for CascadingAllocator, arenas of ARENA_SIZE bytes are taken from Parent
+	and managed by an Allocator that is initialized with an AllocatedBlock.
+	*/
+	template<typename Allocator, typename Parent, size_t ARENA_SIZE>
+	class ArenaFactory : public Parent
+	{
+	public:
+		typedef Allocator AllocatorType;
+
+		enum : size_t { ArenaSize = ARENA_SIZE };
+	};
+
+	/*
+	creates a new arena from Factory whenever the existing ones are full.
+	The Allocator object of an arena lives at the start of the arena, the arenas are kept
+	in a table sorted by address so deallocate finds the owner with a binary search.
+	*/
+	template<typename Factory>
+	class CascadingAllocator : public Factory
+	{
+		typedef typename Factory::AllocatorType MyAllocator;
+
+		enum : size_t
+		{
+			ArenaAlignment = 64,
+			AllocatorSize = GetAlignedSize<sizeof(MyAllocator), ArenaAlignment>::size
+		};
+
+		static_assert((size_t)Factory::ArenaSize > (size_t)AllocatorSize, "");
+
+		struct Arena
+		{
+			u8* begin;
+			u8* end;
+			MyAllocator* allocator;
+		};
+
+		Arena* m_arenas;
+		size_t m_arenaCount;
+		size_t m_arenaCapacity;
+		size_t m_current;
+
+		// index of the first arena that starts after ptr
+		size_t upperBound(const u8* ptr) const
+		{
+			size_t first = 0;
+			size_t count = m_arenaCount;
+			while (count > 0)
+			{
+				auto step = count / 2;
+				if (m_arenas[first + step].begin <= ptr)
+				{
+					first += step + 1;
+					count -= step + 1;
+				}
+				else
+				{
+					count = step;
+				}
+			}
+
+			return first;
+		}
+
+		size_t findOwner(const AllocatedBlock block) const
+		{
+			auto index = upperBound(block.ptr);
+			if (index == 0)
+				return m_arenaCount;
+
+			auto &arena = m_arenas[index - 1];
+			return (block.ptr < arena.end) ? index - 1 : m_arenaCount;
+		}
+
+		bool growTable()
+		{
+			auto capacity = (m_arenaCapacity == 0) ? 8 : m_arenaCapacity * 2;
+			auto block = Factory::allocate(sizeof(Arena) * capacity, __alignof(Arena));
+			if (block.ptr == nullptr)
+				return false;
+
+			if (m_arenas)
+			{
+				::memcpy(block.ptr, m_arenas, sizeof(Arena) * m_arenaCount);
+				Factory::deallocate({ (u8*)m_arenas, sizeof(Arena) * m_arenaCapacity });
+			}
+
+			m_arenas = (Arena*)block.ptr;
+			m_arenaCapacity = capacity;
+			return true;
+		}
+
+		// returns the index of the new arena or m_arenaCount on failure
+		size_t createArena()
+		{
+			if (m_arenaCount == m_arenaCapacity && !growTable())
+				return m_arenaCount;
+
+			auto block = Factory::allocate(Factory::ArenaSize, ArenaAlignment);
+			if (block.ptr == nullptr)
+				return m_arenaCount;
+
+			auto allocator = new (block.ptr) MyAllocator();
+			allocator->initialize({ block.ptr + AllocatorSize, block.size - AllocatorSize });
+
+			auto index = upperBound(block.ptr);
+			::memmove(m_arenas + index + 1, m_arenas + index, sizeof(Arena) * (m_arenaCount - index));
+			m_arenas[index] = { block.ptr, block.ptr + block.size, allocator };
+			++m_arenaCount;
+
+			return index;
+		}
+
+		void freeArena(const Arena &arena)
+		{
+			arena.allocator->release();
+			arena.allocator->~MyAllocator();
+			Factory::deallocate({ arena.begin, (size_t)(arena.end - arena.begin) });
+		}
+
+		// gives the arena back to Factory and removes it from the table
+		void destroyArena(size_t index)
+		{
+			freeArena(m_arenas[index]);
+
+			--m_arenaCount;
+			::memmove(m_arenas + index, m_arenas + index + 1, sizeof(Arena) * (m_arenaCount - index));
+			if (m_current > index)
+				--m_current;
+		}
+
+		void destroyArenas()
+		{
+			for (size_t i = 0; i < m_arenaCount; ++i)
+			{
+				freeArena(m_arenas[i]);
+			}
+
+			if (m_arenas)
+			{
+				Factory::deallocate({ (u8*)m_arenas, sizeof(Arena) * m_arenaCapacity });
+			}
+
+			m_arenas = nullptr;
+			m_arenaCount = m_arenaCapacity = m_current = 0;
+		}
+
+	public:
+		CascadingAllocator() :Factory(), m_arenas(nullptr), m_arenaCount(0), m_arenaCapacity(0), m_current(0) {}
+
+		CascadingAllocator(const CascadingAllocator&) = delete;
+		CascadingAllocator& operator=(const CascadingAllocator&) = delete;
+
+		~CascadingAllocator()
+		{
+			destroyArenas();
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (size == 0)
+				return{ nullptr, 0 };
+
+			// no arena could ever hold it, creating one would only leak it
+			if (getAlignedSize(size, alignment) > Factory::ArenaSize - AllocatorSize)
+				return{ nullptr, 0 };
+
+			if (m_current < m_arenaCount)
+			{
+				auto block = m_arenas[m_current].allocator->allocate(size, alignment);
+				if (block.ptr)
+					return block;
+			}
+
+			for (size_t i = 0; i < m_arenaCount; ++i)
+			{
+				if (i == m_current)
+					continue;
+
+				auto block = m_arenas[i].allocator->allocate(size, alignment);
+				if (block.ptr)
+				{
+					m_current = i;
+					return block;
+				}
+			}
+
+			auto index = createArena();
+			if (index == m_arenaCount)
+				return{ nullptr, 0 };
+
+			// e.g. a size above the limit of MyAllocator, an empty arena will not do better next time
+			auto block = m_arenas[index].allocator->allocate(size, alignment);
+			if (block.ptr == nullptr)
+			{
+				destroyArena(index);
+				return block;
+			}
+
+			m_current = index;
+			return block;
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr == nullptr)
+				return allocate(size, alignment);
+
+			auto owner = findOwner(block);
+			if (owner == m_arenaCount)
+				return{ nullptr, 0 };
+
+			// the arena's reallocate is not used, some allocators free the old block when it fails
+			auto newBlock = tryExpandInPlace(*m_arenas[owner].allocator, block, size, alignment);
+			if (newBlock.ptr)
+				return newBlock;
+
+			newBlock = allocate(size, alignment);
+			if (newBlock.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+				m_arenas[findOwner(block)].allocator->deallocate(block);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (block.ptr == nullptr)
+				return 0;
+
+			auto owner = findOwner(block);
+			if (owner == m_arenaCount)
+				return 0;
+
+			return m_arenas[owner].allocator->deallocate(block);
+		}
+
+		void deallocateAll()
+		{
+			for (size_t i = 0; i < m_arenaCount; ++i)
+			{
+				m_arenas[i].allocator->deallocateAll();
+			}
+			m_current = 0;
+		}
+
+		// gives all arenas back to the factory
+		AllocatedBlock release()
+		{
+			destroyArenas();
+			return{ nullptr, 0 };
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			return findOwner(block) != m_arenaCount;
+		}
+
+		size_t getArenaCount() const { return m_arenaCount; }
+	};
+}
@@ -77,6 +77,11 @@ namespace vx
 			return m_ptr->reallocate(block, size, alignment);
 		}
 
+		AllocatedBlock try_expand_in_place(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			return tryExpandInPlace(*m_ptr, block, size, alignment);
+		}
+
 		void deallocate(const AllocatedBlock block)
 		{
 			m_ptr->deallocate(block);
@@ -90,7 +95,7 @@ namespace vx
 		{
 			static const auto& get()
 			{
-				static const auto typeInfo{ get_constexpr(); };
+				static const auto typeInfo{ get_constexpr() };
 				return typeInfo;
 			}
 
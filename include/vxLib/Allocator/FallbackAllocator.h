@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <tuple>
+
+namespace vx
+{
+	/*
+	tries Primary first and hands the request to Fallback if that fails.
+	Ownership is decided by Primary::contains, which is a range check for all arena based allocators.
+	*/
+	template<typename Primary, typename Fallback>
+	class FallbackAllocator : public Primary, public Fallback
+	{
+	public:
+		FallbackAllocator() :Primary(), Fallback() {}
+
+		template<typename Arg0, typename Arg1>
+		FallbackAllocator(Arg0 &&arg0, Arg1 &&arg1) : Primary(std::forward<Arg0>(arg0)), Fallback(std::forward<Arg1>(arg1)) {}
+
+		template<typename Arg0, typename Arg1>
+		void initialize(Arg0 &&arg0, Arg1 &&arg1)
+		{
+			Primary::initialize(std::forward<Arg0>(arg0));
+			Fallback::initialize(std::forward<Arg1>(arg1));
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			auto block = Primary::allocate(size, alignment);
+			if (block.ptr == nullptr)
+				block = Fallback::allocate(size, alignment);
+
+			return block;
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr == nullptr)
+				return allocate(size, alignment);
+
+			if (!Primary::contains(block))
+				return Fallback::reallocate(block, size, alignment);
+
+			// Primary::reallocate is not used, some allocators free the old block when it fails
+			auto newBlock = tryExpandInPlace(static_cast<Primary&>(*this), block, size, alignment);
+			if (newBlock.ptr != nullptr)
+				return newBlock;
+
+			newBlock = Primary::allocate(size, alignment);
+			if (newBlock.ptr == nullptr)
+				newBlock = Fallback::allocate(size, alignment);
+
+			if (newBlock.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+				Primary::deallocate(block);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (Primary::contains(block))
+				return Primary::deallocate(block);
+
+			return Fallback::deallocate(block);
+		}
+
+		void deallocateAll()
+		{
+			Primary::deallocateAll();
+			Fallback::deallocateAll();
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			return Primary::contains(block) || Fallback::contains(block);
+		}
+
+		auto release()
+		{
+			return std::make_tuple(Primary::release(), Fallback::release());
+		}
+	};
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/LinearAllocator.h>
+#include <atomic>
+
+namespace vx
+{
+	/*
+	scratch memory for FRAME_COUNT frames in flight. Every frame is split into MAX_WORKER_COUNT linear slices,
+	each worker only bumps its own slice so no atomics are needed on the allocation path.
+	A frame is identified by a fence value > 0 that increases every frame, its memory can be reused once
+	retire has been called with that fence or a later one. Slices reset lazily on first use in a new frame,
+	so retire and beginFrame are O(1).
+	beginFrame needs to happen-before the worker allocations of that frame, e.g. through the job system.
+	*/
+	template<size_t FRAME_COUNT, size_t MAX_WORKER_COUNT>
+	class FrameAllocator
+	{
+		static_assert(FRAME_COUNT > 0 && MAX_WORKER_COUNT > 0, "");
+
+		struct VX_ALIGN(64) Slice
+		{
+			LinearAllocator allocator;
+			u64 fence;
+		};
+
+		Slice m_slices[FRAME_COUNT][MAX_WORKER_COUNT];
+		u64 m_frameFences[FRAME_COUNT];
+		u64 m_currentFence;
+		size_t m_currentFrame;
+		std::atomic<u64> m_retiredFence;
+		AllocatedBlock m_block;
+
+		LinearAllocator& getSlice(u32 worker)
+		{
+			VX_ASSERT(worker < MAX_WORKER_COUNT);
+
+			auto &slice = m_slices[m_currentFrame][worker];
+			if (slice.fence != m_currentFence)
+			{
+				slice.allocator.deallocateAll();
+				slice.fence = m_currentFence;
+			}
+
+			return slice.allocator;
+		}
+
+	public:
+		// allocator for a single worker, can be handed to containers
+		class WorkerAllocator
+		{
+			FrameAllocator* m_frameAllocator;
+			u32 m_worker;
+
+		public:
+			WorkerAllocator() :m_frameAllocator(nullptr), m_worker(0) {}
+			WorkerAllocator(FrameAllocator* frameAllocator, u32 worker) :m_frameAllocator(frameAllocator), m_worker(worker) {}
+
+			AllocatedBlock allocate(size_t size, size_t alignment)
+			{
+				return m_frameAllocator->allocate(m_worker, size, alignment);
+			}
+
+			AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+			{
+				return m_frameAllocator->reallocate(m_worker, block, size, alignment);
+			}
+
+			u32 deallocate(const AllocatedBlock block)
+			{
+				return m_frameAllocator->deallocate(m_worker, block);
+			}
+
+			void swap(WorkerAllocator &other)
+			{
+				std::swap(m_frameAllocator, other.m_frameAllocator);
+				std::swap(m_worker, other.m_worker);
+			}
+		};
+
+		enum : size_t { FrameCount = FRAME_COUNT, MaxWorkerCount = MAX_WORKER_COUNT };
+
+		FrameAllocator() :m_slices(), m_frameFences(), m_currentFence(0), m_currentFrame(0), m_retiredFence(0), m_block() {}
+
+		explicit FrameAllocator(const AllocatedBlock block) :FrameAllocator() { initialize(block); }
+
+		FrameAllocator(const FrameAllocator&) = delete;
+		FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+		~FrameAllocator() {}
+
+		// splits block evenly between all frames and workers
+		void initialize(const AllocatedBlock block)
+		{
+			auto sliceSize = (block.size / (FRAME_COUNT * MAX_WORKER_COUNT)) & ~size_t(63);
+			if (sliceSize == 0)
+				return;
+
+			auto ptr = block.ptr;
+			for (size_t i = 0; i < FRAME_COUNT; ++i)
+			{
+				for (size_t j = 0; j < MAX_WORKER_COUNT; ++j)
+				{
+					m_slices[i][j].allocator.initialize({ ptr, sliceSize });
+					m_slices[i][j].fence = 0;
+					ptr += sliceSize;
+				}
+
+				m_frameFences[i] = 0;
+			}
+
+			m_currentFence = 0;
+			m_currentFrame = 0;
+			m_retiredFence.store(0, std::memory_order_relaxed);
+			m_block = block;
+		}
+
+		AllocatedBlock release()
+		{
+			for (size_t i = 0; i < FRAME_COUNT; ++i)
+			{
+				for (size_t j = 0; j < MAX_WORKER_COUNT; ++j)
+				{
+					m_slices[i][j].allocator.release();
+				}
+			}
+
+			auto block = m_block;
+			m_block.ptr = nullptr;
+			m_block.size = 0;
+
+			return block;
+		}
+
+		// returns false if the frame that used the same memory before has not been retired yet
+		bool beginFrame(u64 fence)
+		{
+			VX_ASSERT(fence > m_currentFence);
+
+			auto frame = fence % FRAME_COUNT;
+			auto previousFence = m_frameFences[frame];
+			if (previousFence != 0 && previousFence > m_retiredFence.load(std::memory_order_acquire))
+				return false;
+
+			m_frameFences[frame] = fence;
+			m_currentFrame = frame;
+			m_currentFence = fence;
+
+			return true;
+		}
+
+		// all frames up to and including fence are no longer in use, may be called from any thread
+		void retire(u64 fence)
+		{
+			auto retired = m_retiredFence.load(std::memory_order_relaxed);
+			while (fence > retired && !m_retiredFence.compare_exchange_weak(retired, fence, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		bool isRetired(u64 fence) const
+		{
+			return fence <= m_retiredFence.load(std::memory_order_acquire);
+		}
+
+		AllocatedBlock allocate(u32 worker, size_t size, size_t alignment)
+		{
+			return getSlice(worker).allocate(size, alignment);
+		}
+
+		AllocatedBlock reallocate(u32 worker, const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			return getSlice(worker).reallocate(block, size, alignment);
+		}
+
+		// only the last allocation of a worker gives memory back, everything else is freed with the frame
+		u32 deallocate(u32 worker, const AllocatedBlock block)
+		{
+			return getSlice(worker).deallocate(block);
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			return (block.ptr >= m_block.ptr) && (block.ptr < m_block.ptr + m_block.size);
+		}
+
+		WorkerAllocator getWorkerAllocator(u32 worker)
+		{
+			return WorkerAllocator(this, worker);
+		}
+
+		u64 getCurrentFence() const { return m_currentFence; }
+	};
+}
@@ -35,19 +35,11 @@ namespace vx
 			FreelistNode* next;
 			size_t size;
 		};
-	};
-
-	template<typename Super, size_t MAX_NODE_COUNT, size_t MIN_SIZE, size_t MAX_SIZE>
-	class Freelist : public Super
-	{
-		const static u32 MAGIC_NUMBER = 0x1337b0b;
-
-		typedef detail::FreelistNode Node;
 
 		template<size_t MIN, size_t MAX>
-		struct SizeCheck
+		struct FreelistSizeCheck
 		{
-			static_assert(sizeof(Node) <= MIN, "");
+			static_assert(sizeof(FreelistNode) <= MIN, "");
 
 			inline bool operator()(size_t size)
 			{
@@ -56,9 +48,9 @@ namespace vx
 		};
 
 		template<size_t SZ>
-		struct SizeCheck<SZ, SZ>
+		struct FreelistSizeCheck<SZ, SZ>
 		{
-			static_assert(sizeof(Node) <= SZ, "");
+			static_assert(sizeof(FreelistNode) <= SZ, "");
 
 			inline bool operator()(size_t size)
 			{
@@ -67,7 +59,7 @@ namespace vx
 		};
 
 		template<>
-		struct SizeCheck<0, 0>
+		struct FreelistSizeCheck<0, 0>
 		{
 			inline bool operator()(size_t)
 			{
@@ -76,25 +68,33 @@ namespace vx
 		};
 
 		template<size_t MAX_COUNT>
-		struct NodeCountCheck
+		struct FreelistNodeCountCheck
 		{
 			bool operator()(size_t count)
 			{
-				return count < MAX_COUNT
+				return count < MAX_COUNT;
 			}
 		};
 
 		template<>
-		struct NodeCountCheck<0>
+		struct FreelistNodeCountCheck<0>
 		{
 			bool operator()(size_t)
 			{
 				return true;
 			}
 		};
+	};
+
+	template<typename Super, size_t MAX_NODE_COUNT, size_t MIN_SIZE, size_t MAX_SIZE>
+	class Freelist : public Super
+	{
+		const static u32 MAGIC_NUMBER = 0x1337b0b;
+
+		typedef detail::FreelistNode Node;
 
-		typedef SizeCheck<MIN_SIZE, MAX_SIZE> MySizeCheck;
-		typedef NodeCountCheck<MAX_NODE_COUNT> MyNodeCountCheck;
+		typedef detail::FreelistSizeCheck<MIN_SIZE, MAX_SIZE> MySizeCheck;
+		typedef detail::FreelistNodeCountCheck<MAX_NODE_COUNT> MyNodeCountCheck;
 
 		static_assert(MIN_SIZE <= MAX_SIZE, "");
 		//static_assert(sizeof(Node) <= MIN_SIZE, "");
@@ -170,8 +170,8 @@ namespace vx
 			auto newBlock = allocate(size, alignment);
 			if (newBlock.ptr)
 			{
-				memcpy(newBlock.ptr, block.ptr, block.size);
-				memset(block.ptr, 0, block.size);
+				::memcpy(newBlock.ptr, block.ptr, block.size);
+				::memset(block.ptr, 0, block.size);
 			}
 
 			deallocate(block);
@@ -24,11 +24,19 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
-#include <vxLib/Allocator/MultiBlockAllocator.h>
+#include <vxLib/Allocator/Bitmap.h>
+#include <vxLib/Allocator/SharedAllocator.h>
 
 namespace vx
 {
 	/*
+	manages offsets into a heap that is not addressable by the host, e.g. a gpu buffer or a shared memory ring
+	read by another process. The bitmap and the deferred free queue live in host memory handed to initialize,
+	getRequiredBytes returns its size.
+	deallocate(block, fence) queues the block until retire is called with that fence or a later one,
+	fences need to increase monotonically. Queued blocks are returned in queue order.
+	All calls are serialized with a spin lock, Recorder suballocates pages for a single thread without locking.
+
 	BLOCK_SIZE: size of allocation, needs to be aligned by ALIGNMENT
 	ALIGNMENT: alignment of blocks
 	MAX_BLOCK_COUNT: maximum amount of blocks used by an allocation
@@ -38,232 +46,249 @@ namespace vx
 	{
 		static_assert(GetAlignedSize<BLOCK_SIZE, ALIGNMENT>::size == BLOCK_SIZE, "");
 
-		enum :u64 { BitsSizeT = sizeof(u64) * 8 };
+		typedef detail::SharedAllocatorLockGuard LockGuard;
 
-		u64 m_firstOffset;
-		union
+		struct DeferredFree
 		{
-			u32* m_bitsPtr;
-			u64 m_bits;
+			u64 fence;
+			u32 blockIndex;
+			u32 blockCount;
 		};
+
+		Bitmap m_bitmap;
+		// every queued block is unique, so the queue never holds more than m_blockCount entries
+		DeferredFree* m_deferred;
+		u64 m_deferredHead;
+		u64 m_deferredTail;
+		u64 m_retiredFence;
+		u64 m_firstOffset;
 		u64 m_remainingBlocks;
 		u64 m_blockCount;
 		u64 m_capacity;
+		AllocatedBlock m_memory;
+		mutable detail::SharedAllocatorLock m_lock;
 
-		u32* getBitPtr()
+		static u64 countBlocks(u64 size)
 		{
-			return (m_blockCount <= BitsSizeT) ? (u32*)&m_bits : m_bitsPtr;
+			return (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
 		}
 
-		u64 countBlocks(u64 capacity)
+		static size_t getBitmapBytes(u64 blockCount)
 		{
-			return capacity / BLOCK_SIZE;
+			return getAlignedSize(Bitmap::getRequiredBytes(blockCount), __alignof(DeferredFree));
 		}
 
-		bool findEmptyBit(u32* bitsPtr, u64* resultBit, u64 blockCount)
+		u64 getBlockIndex(u64 offset) const
 		{
-			u64 freeConiguousBlocks = 0;
+			VX_ASSERT(offset >= m_firstOffset);
+			auto blockIndex = (offset - m_firstOffset) / BLOCK_SIZE;
+			VX_ASSERT(blockIndex < m_blockCount);
 
-			u64 resultBlock = 0;
-			u64 block = 0;
+			return blockIndex;
+		}
 
-			auto blocksNeeded = blockCount;
-			auto remainingBlocks = m_blockCount;
-			while (remainingBlocks >= blockCount)
-			{
-				auto p = *bitsPtr++;;
-				auto bitsToCheck = (remainingBlocks < 32) ? remainingBlocks : 32;
+		GpuAllocatedBlock allocateImpl(u64 size, u64 alignment)
+		{
+			if (size == 0 || alignment > ALIGNMENT)
+				return{ 0, 0 };
 
-				int offset = (freeConiguousBlocks == 0) ? ntz(p) : 0;
-				auto blocks = bitsToCheck - offset;
-				blocks = (blocksNeeded < blocks) ? blocksNeeded : blocks;
+			auto blockCount = countBlocks(getAlignedSize(size, alignment));
+			if (blockCount > m_remainingBlocks || blockCount > MAX_BLOCK_COUNT)
+				return{ 0, 0 };
 
-				auto index = ffstrl(rev(p >> offset), (int)blocks);
-				if (index != 32)
-				{
-					if (freeConiguousBlocks == 0)
-					{
-						resultBlock = block + offset;
-					}
+			size_t resultBlock = 0;
+			if (!m_bitmap.findRun(blockCount, &resultBlock))
+				return{ 0, 0 };
 
-					freeConiguousBlocks += blocks;
-					blocksNeeded -= blocks;
-				}
-				else
-				{
-					freeConiguousBlocks = 0;
-					blocksNeeded = blockCount;
-				}
+			m_bitmap.clearRange(resultBlock, blockCount);
+			m_remainingBlocks -= blockCount;
 
-				if (freeConiguousBlocks >= blockCount)
-				{
-					*resultBit = resultBlock;
-					return true;
-				}
+			return{ m_firstOffset + BLOCK_SIZE * resultBlock, blockCount * BLOCK_SIZE };
+		}
 
-				block += 32;
+		void deallocateImpl(const GpuAllocatedBlock block)
+		{
+			auto blockCount = countBlocks(block.size);
+			m_bitmap.setRange(getBlockIndex(block.offset), blockCount);
+			m_remainingBlocks += blockCount;
+		}
 
-				remainingBlocks -= bitsToCheck;
-			}
+		void deferImpl(const GpuAllocatedBlock block, u64 fence)
+		{
+			VX_ASSERT(m_deferredTail - m_deferredHead < m_blockCount);
 
-			return false;
+			auto &entry = m_deferred[m_deferredTail % m_blockCount];
+			entry.fence = fence;
+			entry.blockIndex = (u32)getBlockIndex(block.offset);
+			entry.blockCount = (u32)countBlocks(block.size);
+			++m_deferredTail;
 		}
 
-		bool hasFreeBits(u32* bitsPtr, u64 blockIndex, u64 blockCount)
+	public:
+		enum : u64 { MaxAllocSize = BLOCK_SIZE * MAX_BLOCK_COUNT };
+
+		/*
+		bump allocates from pages taken from the parent allocator, one Recorder per recording thread.
+		Everything allocated between begin and end is queued with the fence passed to begin,
+		so it is freed by retire(fence) and never individually.
+		*/
+		class Recorder
 		{
-			auto needToCheck = blockCount;
-			for (u64 i = 0; i < blockCount; ++i)
-			{
-				auto blockIdx = blockIndex + i;
+			GpuMultiBlockAllocator* m_parent;
+			u64 m_pageSize;
+			u64 m_fence;
+			u64 m_head;
+			u64 m_end;
 
-				auto byte = blockIdx / 32;
-				auto bit = blockIdx & 31;
+		public:
+			Recorder() :m_parent(nullptr), m_pageSize(0), m_fence(0), m_head(0), m_end(0) {}
 
-				if (bitsPtr[byte] != 0)
-				{
-					--needToCheck;
-				}
-				else
-				{
-					break;
-				}
+			// pageSize is rounded up to whole blocks and limited by MaxAllocSize
+			Recorder(GpuMultiBlockAllocator* parent, u64 pageSize) :m_parent(parent), m_pageSize(0), m_fence(0), m_head(0), m_end(0)
+			{
+				pageSize = countBlocks(pageSize) * BLOCK_SIZE;
+				m_pageSize = (pageSize < MaxAllocSize) ? pageSize : (u64)MaxAllocSize;
 			}
 
-			return (needToCheck == 0);
-		}
-
-		void setBits(u32* bitsPtr, u64 blockIndex, u64 blockCount)
-		{
-			for (u64 i = 0; i < blockCount; ++i)
+			void begin(u64 fence)
 			{
-				auto blockIdx = blockIndex + i;
+				m_fence = fence;
+				m_head = m_end = 0;
+			}
 
-				auto byte = blockIdx / 32;
-				auto bit = blockIdx & 31;
+			GpuAllocatedBlock allocate(u64 size, u64 alignment)
+			{
+				if (size == 0 || alignment > ALIGNMENT)
+					return{ 0, 0 };
 
-				bitsPtr[byte] |= (1 << bit);
-			}
-		}
+				auto offset = getAlignedSize(m_head, alignment);
+				if (offset + size <= m_end)
+				{
+					m_head = offset + size;
+					return{ offset, size };
+				}
 
-		void clearBits(u64 blockIndex, u64 blockCount)
-		{
-			auto bitsPtr = getBitPtr();
+				if (size > m_pageSize)
+					return m_parent->allocateDeferred(size, alignment, m_fence);
 
-			for (u64 i = 0; i < blockCount; ++i)
-			{
-				auto blockIdx = blockIndex + i;
+				auto page = m_parent->allocateDeferred(m_pageSize, ALIGNMENT, m_fence);
+				if (page.size == 0)
+					return{ 0, 0 };
 
-				auto byte = blockIdx / 32;
-				auto bit = blockIdx & 31;
+				m_head = page.offset + size;
+				m_end = page.offset + page.size;
+				return{ page.offset, size };
+			}
 
-				bitsPtr[byte] &= ~(1 << bit);
+			// the rest of the current page is freed together with the pages already handed out
+			void end()
+			{
+				m_head = m_end = 0;
 			}
-		}
+		};
 
-	public:
-		enum : u64 { MaxAllocSize = BLOCK_SIZE * MAX_BLOCK_COUNT };
+		GpuMultiBlockAllocator() :m_bitmap(), m_deferred(nullptr), m_deferredHead(0), m_deferredTail(0), m_retiredFence(0), m_firstOffset(0), m_remainingBlocks(0), m_blockCount(0), m_capacity(0), m_memory({ nullptr, 0 }), m_lock() { }
 
-		GpuMultiBlockAllocator() : m_firstOffset(0), m_bitsPtr(nullptr), m_remainingBlocks(0), m_blockCount(0), m_capacity(0) { }
+		GpuMultiBlockAllocator(const AllocatedBlock memory, u64 capacity, u64 offset = 0) :GpuMultiBlockAllocator() { initialize(memory, capacity, offset); }
 
-		GpuMultiBlockAllocator(u64 capacity, u64 offset = 0) : m_firstOffset(offset), m_bitsPtr(nullptr), m_remainingBlocks(0), m_blockCount(0), m_capacity(capacity) { initialize(block); }
+		GpuMultiBlockAllocator(const GpuMultiBlockAllocator&) = delete;
+		GpuMultiBlockAllocator& operator=(const GpuMultiBlockAllocator&) = delete;
 
 		~GpuMultiBlockAllocator() {}
 
-		void initialize(u64 capacity, u64 offset = 0)
+		// host memory needed by initialize, aligned to 8
+		static size_t getRequiredBytes(u64 capacity)
 		{
-			auto blockCount = countBlocks(capacity);
-			if (blockCount == 0)
-				return;
-
-			if (blockCount <= BitsSizeT)
-			{
-				m_bits = 0xffffffffffffffff;
-			}
-			else
-			{
-				auto requiredBytes = (blockCount + 7) / 8;
-				requiredBytes = vx::getAlignedSize(requiredBytes, __alignof(u32));
-				auto requiredBlocksForBits = (requiredBytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
-
-				auto bitblockSize = requiredBlocksForBits * BLOCK_SIZE;
-				VX_ASSERT(bitblockSize % sizeof(u32) == 0);
+			auto blockCount = capacity / BLOCK_SIZE;
+			return getBitmapBytes(blockCount) + blockCount * sizeof(DeferredFree);
+		}
 
-				m_bitsPtr = new u32[bitblockSize / 4];
-				std::memset(m_bitsPtr, 0xff, bitblockSize);
-			}
+		void initialize(const AllocatedBlock memory, u64 capacity, u64 offset = 0)
+		{
+			auto blockCount = capacity / BLOCK_SIZE;
+			if (blockCount == 0 || blockCount > 0xffffffff || memory.size < getRequiredBytes(capacity))
+				return;
 
+			LockGuard guard(&m_lock);
+			m_bitmap.initialize(memory.ptr, blockCount);
+			m_deferred = (DeferredFree*)(memory.ptr + getBitmapBytes(blockCount));
+			m_deferredHead = m_deferredTail = 0;
+			m_retiredFence = 0;
 			m_firstOffset = offset;
 			m_remainingBlocks = blockCount;
 			m_blockCount = blockCount;
 			m_capacity = capacity;
+			m_memory = memory;
 		}
 
-		void release()
+		// returns the host memory passed to initialize
+		AllocatedBlock release()
 		{
+			LockGuard guard(&m_lock);
+			auto memory = m_memory;
+
+			m_bitmap.release();
+			m_deferred = nullptr;
+			m_deferredHead = m_deferredTail = 0;
 			m_firstOffset = 0;
-			m_bitsPtr = nullptr;
 			m_remainingBlocks = 0;
+			m_blockCount = 0;
 			m_capacity = 0;
+			m_memory = { nullptr, 0 };
+
+			return memory;
 		}
 
 		GpuAllocatedBlock allocate(u64 size, u64 alignment)
 		{
-			if (size == 0 || alignment > ALIGNMENT)
-				return{ 0, 0 };
-
-			auto alignedSize = getAlignedSize(size, alignment);
-
-			auto blockCount = (alignedSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
-			if (blockCount > m_remainingBlocks || blockCount > MAX_BLOCK_COUNT)
-				return{ 0, 0 };
-
-			auto bitsPtr = getBitPtr();
-			u64 resultBlock = 0;
-			if (!findEmptyBit(bitsPtr, &resultBlock, blockCount))
-				return{ 0, 0 };
-
-			clearBits(resultBlock, blockCount);
-			m_remainingBlocks -= blockCount;
+			LockGuard guard(&m_lock);
+			return allocateImpl(size, alignment);
+		}
 
-			auto offset = BLOCK_SIZE * resultBlock;
+		// allocates and queues the block with fence in one step, it is freed by retire(fence)
+		GpuAllocatedBlock allocateDeferred(u64 size, u64 alignment, u64 fence)
+		{
+			LockGuard guard(&m_lock);
+			auto block = allocateImpl(size, alignment);
+			if (block.size != 0)
+			{
+				deferImpl(block, fence);
+			}
 
-			return{ m_firstOffset + offset, blockCount * BLOCK_SIZE };
+			return block;
 		}
 
 		GpuAllocatedBlock reallocate(const GpuAllocatedBlock block, u64 size, u64 alignment)
 		{
-			bool isAligned = (getAlignedPtr(block.ptr, alignment) == block.ptr);
+			bool isAligned = (getAlignedSize(block.offset, alignment) == block.offset);
 			auto alignedSize = getAlignedSize(size, alignment);
 			if ((block.size >= alignedSize) && isAligned)
 				return block;
 
-			if (isAligned)
+			if (isAligned && block.size != 0)
 			{
-				auto blockIndex = (block.ptr - m_firstOffset) / BLOCK_SIZE;
-				auto oldBlockCount = (block.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-				auto newBlockCount = (alignedSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+				LockGuard guard(&m_lock);
 
-				auto checkIndex = blockIndex + oldBlockCount;
+				auto blockIndex = getBlockIndex(block.offset);
+				auto oldBlockCount = countBlocks(block.size);
+				auto newBlockCount = countBlocks(alignedSize);
 				auto diff = newBlockCount - oldBlockCount;
-				VX_ASSERT(diff != 0);
 
-				if (hasFreeBits(getBitPtr(), checkIndex, diff))
+				if (newBlockCount <= MAX_BLOCK_COUNT && m_bitmap.isRangeSet(blockIndex + oldBlockCount, diff))
 				{
+					m_bitmap.clearRange(blockIndex + oldBlockCount, diff);
 					m_remainingBlocks -= diff;
-					clearBits(checkIndex, diff);
-					return{ block.ptr, alignedSize };
+					return{ block.offset, newBlockCount * BLOCK_SIZE };
 				}
 			}
 
+			// offsets do not address host memory, the caller has to copy the contents
 			auto newBlock = allocate(size, alignment);
-			if (newBlock.ptr)
+			if (newBlock.size != 0)
 			{
-				memcpy(newBlock.ptr, block.ptr, block.size);
-				memset(block.ptr, 0, block.size);
+				deallocate(block);
 			}
 
-			deallocate(block);
-
 			return newBlock;
 		}
 
@@ -272,27 +297,78 @@ namespace vx
 			if (block.size == 0)
 				return 1;
 
-			VX_ASSERT(block.offset >= m_firstOffset);
+			LockGuard guard(&m_lock);
+			deallocateImpl(block);
 
-			auto blockIndex = (block.offset - m_firstOffset) / BLOCK_SIZE;
-			VX_ASSERT(blockIndex < m_blockCount);
+			return 1;
+		}
 
-			auto blockCount = (block.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-			setBits(getBitPtr(), blockIndex, blockCount);
+		// block stays allocated until retire is called with fence or a later fence
+		u32 deallocate(const GpuAllocatedBlock block, u64 fence)
+		{
+			if (block.size == 0)
+				return 1;
 
-			m_remainingBlocks += blockCount;
+			LockGuard guard(&m_lock);
+			if (fence <= m_retiredFence)
+				deallocateImpl(block);
+			else
+				deferImpl(block, fence);
 
 			return 1;
 		}
 
+		// returns the number of blocks that became free
+		u64 retire(u64 fence)
+		{
+			LockGuard guard(&m_lock);
+			if (fence > m_retiredFence)
+				m_retiredFence = fence;
+
+			u64 freedBlocks = 0;
+			while (m_deferredHead != m_deferredTail)
+			{
+				auto &entry = m_deferred[m_deferredHead % m_blockCount];
+				if (entry.fence > m_retiredFence)
+					break;
+
+				m_bitmap.setRange(entry.blockIndex, entry.blockCount);
+				m_remainingBlocks += entry.blockCount;
+				freedBlocks += entry.blockCount;
+				++m_deferredHead;
+			}
+
+			return freedBlocks;
+		}
+
+		// also drops all queued frees
 		void deallocateAll()
 		{
+			LockGuard guard(&m_lock);
+			m_bitmap.setAll();
+			m_deferredHead = m_deferredTail = 0;
+			m_remainingBlocks = m_blockCount;
 		}
 
-		bool contains(const AllocatedBlock block) const
+		bool contains(const GpuAllocatedBlock block) const
 		{
 			auto last = m_firstOffset + BLOCK_SIZE * m_blockCount;
-			return (block.ptr >= m_firstOffset) && (block.ptr < last);
+			return (block.offset >= m_firstOffset) && (block.offset < last);
 		}
+
+		u64 getRemainingBlocks() const
+		{
+			LockGuard guard(&m_lock);
+			return m_remainingBlocks;
+		}
+
+		// free run statistics in blocks, queued frees count as used
+		BitmapRunStats getFreeRunStats() const
+		{
+			LockGuard guard(&m_lock);
+			return m_bitmap.getRunStats();
+		}
+
+		u64 getCapacity() const { return m_capacity; }
 	};
-}
\ No newline at end of file
+}
@@ -42,32 +42,78 @@ namespace vx
 				*last = (size_t)block.offset + block.size;
 			}
 
-			static BlockType allocate(size_t size, size_t alignment)
+			static BlockType allocate(size_t size, size_t alignment, size_t* end, size_t last)
 			{
+				if (size == 0)
+					return{ 0, 0 };
+
 				auto alignedSize = vx::getAlignedSize(size, alignment);
-				auto alignedHead = vx::getAlignedSize(m_head, alignment);
+				auto alignedHead = vx::getAlignedSize(*end, alignment);
 
 				auto newHead = alignedHead + alignedSize;
-				if (newHead > m_capacity)
+				if (newHead > last)
 				{
 					return{ 0, 0 };
 				}
 
-				m_head = newHead;
+				*end = newHead;
 
 				return{ alignedHead, alignedSize };
 			}
 
-			static void deallocate(const BlockType block, size_t* end)
+			static BlockType reallocate(const BlockType block, size_t size, size_t alignment, size_t* end, size_t last)
+			{
+				if (block.size != 0 &&
+					vx::getAlignedSize(block.offset, alignment) == block.offset &&
+					*end == block.offset + block.size)
+				{
+					auto alignedSize = vx::getAlignedSize(size, alignment);
+					if (block.offset + alignedSize > last)
+						return{ 0, 0 };
+
+					*end = block.offset + alignedSize;
+					return{ block.offset, alignedSize };
+				}
+
+				return allocate(size, alignment, end, last);
+			}
+
+			static BlockType expandInPlace(const BlockType block, size_t size, size_t alignment, size_t* end, size_t last)
+			{
+				if (block.size == 0 || *end != block.offset + block.size)
+					return{ 0, 0 };
+
+				auto alignedSize = vx::getAlignedSize(size, alignment);
+				if (block.offset + alignedSize > last)
+					return{ 0, 0 };
+
+				*end = block.offset + alignedSize;
+				return{ block.offset, alignedSize };
+			}
+
+			static u32 deallocate(const BlockType block, size_t* end)
 			{
 				if (block.size == 0)
-					return;
+					return 0;
 
 				auto tmp = block.offset + block.size;
 				if (tmp == *end)
 				{
 					*end = block.offset;
+					return 1;
 				}
+
+				return 0;
+			}
+
+			static BlockType release(size_t begin, size_t last)
+			{
+				return{ begin, last - begin };
+			}
+
+			static bool contains(const BlockType block, size_t begin, size_t last)
+			{
+				return (block.offset >= begin) && (block.offset < last);
 			}
 		};
 
@@ -106,25 +152,44 @@ namespace vx
 				BlockType newBlock{ nullptr, 0 };
 
 				auto alignedPtr = getAlignedPtr(block.ptr, alignment);
-				if (alignedPtr != block.ptr)
-				{
-					newBlock = allocate(size, alignment, end, last);
-					::memcpy(newBlock.ptr, block.ptr, block.size);
-					::memset(block.ptr, 0, block.size);
-
-					deallocate(block, end);
-				}
-				else if (*end == (size_t)(block.ptr + block.size))
+				if (block.ptr != nullptr &&
+					alignedPtr == block.ptr &&
+					*end == (size_t)(block.ptr + block.size))
 				{
 					auto alignedSize = getAlignedSize(size, alignment);
+					if ((size_t)block.ptr + alignedSize > last)
+						return newBlock;
 
 					newBlock = { block.ptr, alignedSize };
 					*end = (size_t)(newBlock.ptr + newBlock.size);
 				}
+				else
+				{
+					newBlock = allocate(size, alignment, end, last);
+					if (newBlock.ptr && block.ptr)
+					{
+						::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+						::memset(block.ptr, 0, block.size);
+					}
+				}
 
 				return newBlock;
 			}
 
+			// only the last allocation can grow or shrink without moving
+			static BlockType expandInPlace(const BlockType block, size_t size, size_t alignment, size_t* end, size_t last)
+			{
+				if (block.ptr == nullptr || *end != (size_t)(block.ptr + block.size))
+					return{ nullptr, 0 };
+
+				auto alignedSize = getAlignedSize(size, alignment);
+				if ((size_t)block.ptr + alignedSize > last)
+					return{ nullptr, 0 };
+
+				*end = (size_t)block.ptr + alignedSize;
+				return{ block.ptr, alignedSize };
+			}
+
 			static u32 deallocate(const BlockType block, size_t* end)
 			{
 				auto tmp = block.ptr + block.size;
@@ -160,6 +225,7 @@ namespace vx
 
 		public:
 			LinearAllocator() :m_begin(0), m_end(0), m_last(0) {}
+			explicit LinearAllocator(const BlockType block) :m_begin(0), m_end(0), m_last(0) { initialize(block); }
 			~LinearAllocator() = default;
 
 			LinearAllocator(const LinearAllocator&) = delete;
@@ -195,11 +261,16 @@ namespace vx
 				return MyImpl::allocate(size, alignment, &m_end, m_last);
 			}
 
-			static BlockType reallocate(const BlockType block, size_t size, size_t alignment)
+			BlockType reallocate(const BlockType block, size_t size, size_t alignment)
 			{
 				return MyImpl::reallocate(block, size, alignment, &m_end, m_last);
 			}
 
+			BlockType try_expand_in_place(const BlockType block, size_t size, size_t alignment)
+			{
+				return MyImpl::expandInPlace(block, size, alignment, &m_end, m_last);
+			}
+
 			u32 deallocate(const BlockType block)
 			{
 				return MyImpl::deallocate(block, &m_end);
@@ -222,7 +293,7 @@ namespace vx
 				return MyImpl::contains(block, m_begin, m_last);
 			}
 
-			size_t capacity() const { return m_last - m_data; }
+			size_t capacity() const { return m_last - m_begin; }
 		};
 	}
 
@@ -27,6 +27,7 @@ SOFTWARE.
 #include <vxLib/Allocator/Allocator.h>
 #include <vxLib/TypeInfo.h>
 #include <stdlib.h>
+#include <cstddef>
 
 namespace vx
 {
@@ -56,9 +57,19 @@ namespace vx
 #ifdef  _VX_PLATFORM_WINDOWS
 			return{ (u8*)_aligned_realloc(block.ptr, alignedSize, alignment), alignedSize };
 #else
-			auto newBlock = allocate(size, alignedSize);
-			::memcpy(newBlock.ptr, block.ptr, block.size);
-			deallocate(block);
+			// malloc alignment is enough, realloc can grow in place and moves large blocks with mremap
+			if (alignment <= __alignof(std::max_align_t))
+			{
+				auto ptr = (u8*)::realloc(block.ptr, alignedSize);
+				return{ ptr, (ptr != nullptr) ? alignedSize : 0 };
+			}
+
+			auto newBlock = allocate(size, alignment);
+			if (newBlock.ptr && block.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+				deallocate(block);
+			}
 			return newBlock;
 #endif
 		}
@@ -25,7 +25,7 @@ SOFTWARE.
 */
 
 #include <vxLib/Allocator/StackAllocator.h>
-#include <vxLib/util/bitops.h>
+#include <vxLib/Allocator/Bitmap.h>
 
 namespace vx
 {
@@ -39,151 +39,35 @@ namespace vx
 	{
 		static_assert(GetAlignedSize<BLOCK_SIZE, ALIGNMENT>::size == BLOCK_SIZE, "");
 
-		template<bool b>
-		struct BitSizeSelector
+		enum : size_t
 		{
-			enum :size_t { value = 64, mask = 0xffffffffffffffff };
+			BitsAlignment = (ALIGNMENT < __alignof(u64)) ? __alignof(u64) : ALIGNMENT
 		};
 
-		template<>
-		struct BitSizeSelector<false>
-		{
-			enum :size_t { value = 32, mask = 0xffffffff};
-		};
-
-		const size_t BitsSizeT{ BitSizeSelector<sizeof(size_t )==sizeof(u64)>::value };
-		const size_t BitMask{ BitSizeSelector<sizeof(size_t) == sizeof(u64)>::mask };
-
 		u8* m_firstBlock;
-		union
-		{
-			u32* m_bitsPtr;
-			size_t m_bits;
-		};
+		Bitmap m_bitmap;
 		size_t m_remainingBlocks;
 		size_t m_blockCount;
 		vx::AllocatedBlock m_block;
 
-		u32* getBitPtr()
-		{
-			return (m_blockCount <= BitsSizeT) ? (u32*)&m_bits : m_bitsPtr;
-		}
-
 		size_t countBlocks(const AllocatedBlock block)
 		{
-			auto alignedPtr = getAlignedPtr(block.ptr, ALIGNMENT);
+			auto alignedPtr = getAlignedPtr(block.ptr, BitsAlignment);
 			auto offset = (size_t)(alignedPtr - block.ptr);
+			if (offset >= block.size)
+				return 0;
+
 			auto remainingSize = block.size - offset;
 
 			return remainingSize / BLOCK_SIZE;
 		}
 
-		bool findEmptyBit(u32* bitsPtr, size_t* resultBit, size_t blockCount)
-		{
-			size_t freeConiguousBlocks = 0;
-
-			size_t resultBlock = 0;
-			size_t block = 0;
-
-			auto blocksNeeded = blockCount;
-			auto remainingBlocks = m_blockCount;
-			while (remainingBlocks >= blockCount)
-			{
-				auto p = *bitsPtr++;;
-				auto bitsToCheck = (remainingBlocks < 32) ? remainingBlocks : 32;
-
-				int offset = (freeConiguousBlocks == 0) ? ntz(p) : 0;
-				auto blocks = bitsToCheck - offset;
-				blocks = (blocksNeeded < blocks) ? blocksNeeded : blocks;
-
-				auto index = ffstrl(rev(p >> offset), (int)blocks);
-				if (index != 32)
-				{
-					if (freeConiguousBlocks == 0)
-					{
-						resultBlock = block + offset;
-					}
-
-					freeConiguousBlocks += blocks;
-					blocksNeeded -= blocks;
-				}
-				else
-				{
-					freeConiguousBlocks = 0;
-					blocksNeeded = blockCount;
-				}
-
-				if (freeConiguousBlocks >= blockCount)
-				{
-					*resultBit = resultBlock;
-					return true;
-				}
-
-				block += 32;
-
-				remainingBlocks -= bitsToCheck;
-			}
-
-			return false;
-		}
-
-		bool hasFreeBits(u32* bitsPtr, size_t blockIndex, size_t blockCount)
-		{
-			auto needToCheck = blockCount;
-			for (size_t i = 0; i < blockCount; ++i)
-			{
-				auto blockIdx = blockIndex + i;
-
-				auto byte = blockIdx / 32;
-				auto bit = blockIdx & 31;
-
-				if (bitsPtr[byte] != 0)
-				{
-					--needToCheck;
-				}
-				else
-				{
-					break;
-				}
-			}
-
-			return (needToCheck == 0);
-		}
-
-		void setBits(u32* bitsPtr, size_t blockIndex, size_t blockCount)
-		{
-			for (size_t i = 0; i < blockCount; ++i)
-			{
-				auto blockIdx = blockIndex + i;
-
-				auto byte = blockIdx / 32;
-				auto bit = blockIdx & 31;
-
-				bitsPtr[byte] |= (1 << bit);
-			}
-		}
-
-		void clearBits(size_t blockIndex, size_t blockCount)
-		{
-			auto bitsPtr = getBitPtr();
-
-			for (size_t i = 0; i < blockCount; ++i)
-			{
-				auto blockIdx = blockIndex + i;
-
-				auto byte = blockIdx / 32;
-				auto bit = blockIdx & 31;
-
-				bitsPtr[byte] &= ~(1 << bit);
-			}
-		}
-
 	public:
 		enum : size_t {MaxAllocSize = BLOCK_SIZE * MAX_BLOCK_COUNT};
 
-		MultiBlockAllocator() : m_firstBlock(nullptr), m_bitsPtr(nullptr), m_remainingBlocks(0), m_blockCount(0), m_block() { }
+		MultiBlockAllocator() : m_firstBlock(nullptr), m_bitmap(), m_remainingBlocks(0), m_blockCount(0), m_block() { }
 
-		explicit MultiBlockAllocator(const AllocatedBlock block) : m_firstBlock(nullptr), m_bitsPtr(nullptr), m_remainingBlocks(0), m_blockCount(0), m_block(block){ initialize(block); }
+		explicit MultiBlockAllocator(const AllocatedBlock block) : m_firstBlock(nullptr), m_bitmap(), m_remainingBlocks(0), m_blockCount(0), m_block(block){ initialize(block); }
 
 		~MultiBlockAllocator() {}
 
@@ -193,27 +77,16 @@ namespace vx
 			if (blockCount == 0)
 				return;
 
-			if (blockCount <= BitsSizeT)
-			{
-				m_bits = BitMask;
-				m_firstBlock = getAlignedPtr(block.ptr, ALIGNMENT);
-			}
-			else
-			{
-				auto requiredBytes = (blockCount + 7) / 8;
-				requiredBytes = vx::getAlignedSize(requiredBytes, __alignof(u32));
-				auto requiredBlocksForBits = (requiredBytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
-				if (requiredBlocksForBits >= blockCount)
-					return;
-
-				blockCount -= requiredBlocksForBits;
+			auto alignedPtr = getAlignedPtr(block.ptr, BitsAlignment);
+			auto requiredBytes = Bitmap::getRequiredBytes(blockCount);
+			auto requiredBlocksForBits = (requiredBytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			if (requiredBlocksForBits >= blockCount)
+				return;
 
-				auto bitblockSize = requiredBlocksForBits * BLOCK_SIZE;
-				m_bitsPtr = (u32*)getAlignedPtr(block.ptr, ALIGNMENT);
-				std::memset(m_bitsPtr, 0xff, bitblockSize);
+			blockCount -= requiredBlocksForBits;
 
-				m_firstBlock = reinterpret_cast<u8*>(m_bitsPtr) + bitblockSize;
-			}
+			m_bitmap.initialize(alignedPtr, blockCount);
+			m_firstBlock = alignedPtr + requiredBlocksForBits * BLOCK_SIZE;
 
 			m_remainingBlocks = blockCount;
 			m_blockCount = blockCount;
@@ -223,8 +96,8 @@ namespace vx
 		AllocatedBlock release()
 		{
 			m_firstBlock = nullptr;
-			m_bitsPtr = nullptr;
-			m_remainingBlocks = 0;
+			m_bitmap.release();
+			m_remainingBlocks = m_blockCount = 0;
 			
 			auto blck = m_block;
 			m_block.ptr = nullptr;
@@ -244,12 +117,11 @@ namespace vx
 			if(blockCount > m_remainingBlocks || blockCount > MAX_BLOCK_COUNT)
 				return{ nullptr, 0 };
 
-			auto bitsPtr = getBitPtr();
 			size_t resultBlock = 0;
-			if(!findEmptyBit(bitsPtr, &resultBlock, blockCount))
+			if(!m_bitmap.findRun(blockCount, &resultBlock))
 				return{ nullptr, 0 };
 
-			clearBits(resultBlock, blockCount);
+			m_bitmap.clearRange(resultBlock, blockCount);
 			m_remainingBlocks -= blockCount;
 
 			auto offset = BLOCK_SIZE * resultBlock;
@@ -274,10 +146,10 @@ namespace vx
 				auto diff = newBlockCount - oldBlockCount;
 				VX_ASSERT(diff != 0);
 
-				if (hasFreeBits(getBitPtr(), checkIndex, diff))
+				if (m_bitmap.isRangeSet(checkIndex, diff))
 				{
 					m_remainingBlocks -= diff;
-					clearBits(checkIndex, diff);
+					m_bitmap.clearRange(checkIndex, diff);
 					return{block.ptr, alignedSize };
 				}
 			}
@@ -285,8 +157,8 @@ namespace vx
 			auto newBlock = allocate(size, alignment);
 			if (newBlock.ptr)
 			{
-				memcpy(newBlock.ptr, block.ptr, block.size);
-				memset(block.ptr, 0, block.size);
+				::memcpy(newBlock.ptr, block.ptr, block.size);
+				::memset(block.ptr, 0, block.size);
 			}
 
 			deallocate(block);
@@ -294,6 +166,29 @@ namespace vx
 			return newBlock;
 		}
 
+		// grows into the free blocks directly behind block, never frees it on failure
+		AllocatedBlock try_expand_in_place(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr == nullptr || getAlignedPtr(block.ptr, alignment) != block.ptr)
+				return{ nullptr, 0 };
+
+			auto alignedSize = getAlignedSize(size, alignment);
+			auto oldBlockCount = (block.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			auto newBlockCount = (alignedSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			if (newBlockCount <= oldBlockCount)
+				return{ block.ptr, block.size };
+
+			auto blockIndex = (block.ptr - m_firstBlock) / BLOCK_SIZE;
+			auto checkIndex = blockIndex + oldBlockCount;
+			auto diff = newBlockCount - oldBlockCount;
+			if (!m_bitmap.isRangeSet(checkIndex, diff))
+				return{ nullptr, 0 };
+
+			m_remainingBlocks -= diff;
+			m_bitmap.clearRange(checkIndex, diff);
+			return{ block.ptr, newBlockCount * BLOCK_SIZE };
+		}
+
 		u32 deallocate(const AllocatedBlock block)
 		{
 			if (block.ptr == nullptr || block.size == 0)
@@ -305,7 +200,7 @@ namespace vx
 			VX_ASSERT(blockIndex < m_blockCount);
 
 			auto blockCount = (block.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-			setBits(getBitPtr(), blockIndex, blockCount);
+			m_bitmap.setRange(blockIndex, blockCount);
 
 			m_remainingBlocks += blockCount;
 
@@ -314,6 +209,8 @@ namespace vx
 
 		void deallocateAll()
 		{
+			m_bitmap.setAll();
+			m_remainingBlocks = m_blockCount;
 		}
 
 		bool contains(const AllocatedBlock block) const
@@ -322,6 +219,12 @@ namespace vx
 			return (block.ptr >= m_firstBlock) && (block.ptr < last);
 		}
 
+		// free run statistics in blocks, largestRun * BLOCK_SIZE is the largest possible allocation
+		BitmapRunStats getFreeRunStats() const
+		{
+			return m_bitmap.getRunStats();
+		}
+
 		void print() const
 		{
 			printStatic();
@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <vxLib/Allocator/VirtualMemory.h>
+
+namespace vx
+{
+	/*
+	gets memory directly from the os in whole pages, usable as the parent of the other allocators
+	or as the source for large LinearAllocator/MultiBlockAllocator arenas.
+	Page type and numa node are chosen per instance, sizes are rounded up to getPageSize(type).
+	allocate fails if the pages cannot be bound to the numa node.
+	*/
+	class PageAllocator : public Allocator<PageAllocator>
+	{
+		PageType m_type;
+		s32 m_numaNode;
+		size_t m_pageSize;
+
+	public:
+		PageAllocator() :m_type(PageType::Default), m_numaNode(AnyNumaNode), m_pageSize(vx::getPageSize(PageType::Default)) {}
+
+		explicit PageAllocator(PageType type, s32 numaNode = AnyNumaNode) :m_type(type), m_numaNode(numaNode), m_pageSize(vx::getPageSize(type)) {}
+
+		~PageAllocator() {}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (size == 0 || alignment > m_pageSize)
+				return{ nullptr, 0 };
+
+			auto alignedSize = getAlignedSize(size, m_pageSize);
+			auto ptr = allocatePages(alignedSize, m_type, m_numaNode);
+			if (ptr == nullptr)
+				return{ nullptr, 0 };
+
+			return{ ptr, alignedSize };
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr == nullptr)
+				return allocate(size, alignment);
+
+			if (alignment > m_pageSize)
+				return{ nullptr, 0 };
+
+			auto alignedSize = getAlignedSize(size, m_pageSize);
+			if (alignedSize == block.size)
+				return block;
+
+			auto ptr = reallocatePages(block.ptr, block.size, alignedSize, m_type, m_numaNode);
+			if (ptr == nullptr)
+				return{ nullptr, 0 };
+
+			return{ ptr, alignedSize };
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (block.ptr == nullptr)
+				return 0;
+
+			deallocatePages(block.ptr, block.size);
+			return 1;
+		}
+
+		void deallocateAll()
+		{
+		}
+
+		bool contains(const AllocatedBlock) const
+		{
+			return true;
+		}
+
+		PageType getPageType() const { return m_type; }
+		s32 getNumaNode() const { return m_numaNode; }
+		size_t getPageSize() const { return m_pageSize; }
+	};
+}
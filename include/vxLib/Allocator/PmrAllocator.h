@@ -0,0 +1,175 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <vxLib/TypeInfo.h>
+#include <memory_resource>
+#include <new>
+#include <cstring>
+#include <cstddef>
+#include <utility>
+
+namespace vx
+{
+	/*
+	std::pmr::memory_resource over a vx allocator policy, owned by value.
+	Use DelegateAllocator to share an allocator that lives somewhere else.
+	FallbackAllocator<StackAllocator<N, A>, PmrAllocator> gives a small inline buffer that spills into an upstream resource.
+	Failed allocations throw std::bad_alloc as memory_resource requires.
+	Every allocation carries a header of max(alignment, sizeof(size_t)) bytes with the size the policy returned.
+	*/
+	template<typename Allocator>
+	class AllocatorResource : public std::pmr::memory_resource
+	{
+		Allocator m_allocator;
+
+	protected:
+		// the policies round sizes in their own way (BitmapBlock, Bucketizer, TlsfAllocator, ...), so the size they
+		// returned is kept in front of the pointer and handed back to deallocate unchanged
+		static size_t getHeaderSize(size_t alignment)
+		{
+			return (alignment < sizeof(size_t)) ? sizeof(size_t) : alignment;
+		}
+
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			auto headerSize = getHeaderSize(alignment);
+			auto block = m_allocator.allocate(headerSize + bytes, (alignment < __alignof(size_t)) ? __alignof(size_t) : alignment);
+			if (block.ptr == nullptr)
+				throw std::bad_alloc();
+
+			auto ptr = block.ptr + headerSize;
+			((size_t*)ptr)[-1] = block.size;
+			return ptr;
+		}
+
+		void do_deallocate(void* p, size_t, size_t alignment) override
+		{
+			auto ptr = (u8*)p;
+			m_allocator.deallocate({ ptr - getHeaderSize(alignment), ((size_t*)ptr)[-1] });
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+		{
+			return this == &other;
+		}
+
+	public:
+		template<typename ...Args>
+		explicit AllocatorResource(Args&& ...args) :m_allocator(std::forward<Args>(args)...) {}
+
+		AllocatorResource(const AllocatorResource&) = delete;
+		AllocatorResource& operator=(const AllocatorResource&) = delete;
+
+		~AllocatorResource() {}
+
+		Allocator& getAllocator() { return m_allocator; }
+		const Allocator& getAllocator() const { return m_allocator; }
+	};
+
+	/*
+	allocator policy over a std::pmr::memory_resource so DynamicArray and SortedArray can use pmr resources.
+	Deallocation has no alignment, so every request uses MaxAlignment and larger alignments fail.
+	contains always returns true, it can only be the last allocator in a FallbackAllocator chain.
+	*/
+	class PmrAllocator
+	{
+		VX_TYPE_INFO
+
+		std::pmr::memory_resource* m_resource;
+
+	public:
+		enum : size_t { MaxAlignment = __alignof(std::max_align_t) };
+
+		PmrAllocator() :m_resource(std::pmr::get_default_resource()) {}
+		explicit PmrAllocator(std::pmr::memory_resource* resource) :m_resource(resource) {}
+		PmrAllocator(const PmrAllocator &rhs) :m_resource(rhs.m_resource) {}
+
+		~PmrAllocator() {}
+
+		PmrAllocator& operator=(const PmrAllocator &rhs)
+		{
+			m_resource = rhs.m_resource;
+			return *this;
+		}
+
+		void swap(PmrAllocator &other)
+		{
+			auto tmp = m_resource;
+			m_resource = other.m_resource;
+			other.m_resource = tmp;
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (size == 0 || alignment > MaxAlignment)
+				return{ nullptr, 0 };
+
+			try
+			{
+				return{ (u8*)m_resource->allocate(size, MaxAlignment), size };
+			}
+			catch (const std::bad_alloc&)
+			{
+				return{ nullptr, 0 };
+			}
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			auto newBlock = allocate(size, alignment);
+			if (newBlock.ptr && block.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+				deallocate(block);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (block.ptr == nullptr)
+				return 1;
+
+			m_resource->deallocate(block.ptr, block.size, MaxAlignment);
+			return 1;
+		}
+
+		void deallocateAll()
+		{
+		}
+
+		bool contains(const AllocatedBlock) const
+		{
+			return true;
+		}
+
+		std::pmr::memory_resource* getResource() const { return m_resource; }
+	};
+}
+
+VX_TYPEINFO_GENERATOR(vx::PmrAllocator)
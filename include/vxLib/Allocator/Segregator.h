@@ -53,7 +53,7 @@ namespace vx
 		Segregator() :Large(), Small() {}
 
 		template<typename Arg0, typename Arg1>
-		Segregator(Arg0 &&arg0, Arg1 &&arg1) : Large(std::forward<Args0>(arg0)), Small(std::forward<Arg1>(arg1)) {}
+		Segregator(Arg0 &&arg0, Arg1 &&arg1) : Large(std::forward<Arg0>(arg0)), Small(std::forward<Arg1>(arg1)) {}
 
 		template<typename Arg0, typename ...Arg1>
 		void initialize(Arg0 &&arg0, Arg1 && ...arg1)
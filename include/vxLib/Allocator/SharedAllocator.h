@@ -0,0 +1,144 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <atomic>
+#if defined(_VX_PLATFORM_WINDOWS)
+#include <intrin.h>
+#elif !defined(_VX_PLATFORM_ANDROID)
+#include <immintrin.h>
+#else
+#include <thread>
+#endif
+
+namespace vx
+{
+	namespace detail
+	{
+		class SharedAllocatorLock
+		{
+			std::atomic<u32> m_flag;
+
+		public:
+			SharedAllocatorLock() :m_flag(0) {}
+
+			void lock()
+			{
+				while (m_flag.exchange(1, std::memory_order_acquire) != 0)
+				{
+					while (m_flag.load(std::memory_order_relaxed) != 0)
+					{
+#ifndef _VX_PLATFORM_ANDROID
+						_mm_pause();
+#else
+						std::this_thread::yield();
+#endif
+					}
+				}
+			}
+
+			void unlock()
+			{
+				m_flag.store(0, std::memory_order_release);
+			}
+		};
+
+		class SharedAllocatorLockGuard
+		{
+			SharedAllocatorLock* m_lock;
+
+		public:
+			explicit SharedAllocatorLockGuard(SharedAllocatorLock* lock) :m_lock(lock) { m_lock->lock(); }
+			~SharedAllocatorLockGuard() { m_lock->unlock(); }
+
+			SharedAllocatorLockGuard(const SharedAllocatorLockGuard&) = delete;
+			SharedAllocatorLockGuard& operator=(const SharedAllocatorLockGuard&) = delete;
+		};
+	}
+
+	/*
+	makes any allocator thread-safe by serializing all calls with a spin lock.
+	Use SharedLinearAllocator, SharedFreelist or SharedMultiBlockAllocator where possible, those don't lock.
+	*/
+	template<typename Super>
+	class SharedAllocator : public Super
+	{
+		typedef detail::SharedAllocatorLockGuard LockGuard;
+
+		mutable detail::SharedAllocatorLock m_lock;
+
+	public:
+		SharedAllocator() :Super(), m_lock() {}
+		explicit SharedAllocator(const AllocatedBlock block) :Super(block), m_lock() {}
+
+		SharedAllocator(const SharedAllocator&) = delete;
+		SharedAllocator& operator=(const SharedAllocator&) = delete;
+
+		~SharedAllocator() {}
+
+		void initialize(const AllocatedBlock block)
+		{
+			LockGuard guard(&m_lock);
+			Super::initialize(block);
+		}
+
+		AllocatedBlock release()
+		{
+			LockGuard guard(&m_lock);
+			return Super::release();
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			LockGuard guard(&m_lock);
+			return Super::allocate(size, alignment);
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			LockGuard guard(&m_lock);
+			return Super::reallocate(block, size, alignment);
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			LockGuard guard(&m_lock);
+			return Super::deallocate(block);
+		}
+
+		void deallocateAll()
+		{
+			LockGuard guard(&m_lock);
+			Super::deallocateAll();
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			LockGuard guard(&m_lock);
+			return Super::contains(block);
+		}
+	};
+}
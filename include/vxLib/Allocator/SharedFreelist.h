@@ -0,0 +1,158 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <atomic>
+
+namespace vx
+{
+	/*
+	lock-free freelist (treiber stack), blocks in [MIN_SIZE, MAX_SIZE] with an alignment of up to ALIGNMENT
+	are handed out as MAX_SIZE blocks and pushed back on deallocate. Everything else goes to Super,
+	which needs to be thread-safe itself (e.g. SharedLinearAllocator).
+	The head stores a 16 bit tag in the upper bits of the pointer to avoid ABA.
+	*/
+	template<typename Super, size_t MIN_SIZE, size_t MAX_SIZE, size_t ALIGNMENT>
+	class SharedFreelist : public Super
+	{
+		struct Node
+		{
+			// atomic since a stale pop may read it while the owner reuses the block
+			std::atomic<Node*> next;
+		};
+
+		static_assert(MIN_SIZE <= MAX_SIZE, "");
+		static_assert(sizeof(Node) <= MAX_SIZE, "");
+		static_assert(GetAlignedSize<MAX_SIZE, ALIGNMENT>::size == MAX_SIZE, "");
+
+		enum : u64
+		{
+			TagShift = 48,
+			PtrMask = (u64(1) << TagShift) - 1
+		};
+
+		std::atomic<u64> m_head;
+
+		static Node* getNode(u64 head)
+		{
+			return (Node*)(head & PtrMask);
+		}
+
+		static u64 makeHead(Node* node, u64 oldHead)
+		{
+			return (u64)node | (((oldHead >> TagShift) + 1) << TagShift);
+		}
+
+		static bool isListSize(size_t size, size_t alignment)
+		{
+			return (size >= MIN_SIZE) && (size <= MAX_SIZE) && (alignment <= ALIGNMENT);
+		}
+
+		Node* pop()
+		{
+			auto head = m_head.load(std::memory_order_acquire);
+			Node* node = nullptr;
+			do
+			{
+				node = getNode(head);
+				if (node == nullptr)
+					return nullptr;
+				// next may be stale if another thread popped the node meanwhile, the tag makes the cas fail then
+			} while (!m_head.compare_exchange_weak(head, makeHead(node->next.load(std::memory_order_relaxed), head), std::memory_order_acquire, std::memory_order_acquire));
+
+			return node;
+		}
+
+		void push(Node* node)
+		{
+			auto head = m_head.load(std::memory_order_relaxed);
+			do
+			{
+				node->next.store(getNode(head), std::memory_order_relaxed);
+			} while (!m_head.compare_exchange_weak(head, makeHead(node, head), std::memory_order_release, std::memory_order_relaxed));
+		}
+
+	public:
+		SharedFreelist() :Super(), m_head(0) {}
+		explicit SharedFreelist(const AllocatedBlock block) :Super(block), m_head(0) {}
+
+		SharedFreelist(const SharedFreelist&) = delete;
+		SharedFreelist& operator=(const SharedFreelist&) = delete;
+
+		~SharedFreelist() {}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (!isListSize(size, alignment))
+				return Super::allocate(size, alignment);
+
+			auto node = pop();
+			if (node)
+				return{ (u8*)node, MAX_SIZE };
+
+			return Super::allocate(MAX_SIZE, ALIGNMENT);
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if ((block.size >= size) && (getAlignedPtr(block.ptr, alignment) == block.ptr))
+				return block;
+
+			auto newBlock = allocate(size, alignment);
+			if (newBlock.ptr && block.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, block.size);
+				deallocate(block);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (block.ptr == nullptr)
+				return 0;
+
+			if (block.size != MAX_SIZE)
+				return Super::deallocate(block);
+
+			push((Node*)block.ptr);
+			return 1;
+		}
+
+		// not thread-safe
+		void deallocateAll()
+		{
+			m_head.store(0, std::memory_order_relaxed);
+			Super::deallocateAll();
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			return Super::contains(block);
+		}
+	};
+}
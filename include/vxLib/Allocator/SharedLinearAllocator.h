@@ -0,0 +1,132 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <atomic>
+
+namespace vx
+{
+	/*
+	lock-free bump allocator, allocate/reallocate/deallocate may be called from any thread.
+	initialize, release and deallocateAll must not run concurrently with other calls.
+	*/
+	class SharedLinearAllocator
+	{
+		std::atomic<size_t> m_end;
+		size_t m_begin;
+		size_t m_last;
+
+	public:
+		SharedLinearAllocator() :m_end(0), m_begin(0), m_last(0) {}
+		explicit SharedLinearAllocator(const AllocatedBlock block) :m_end(0), m_begin(0), m_last(0) { initialize(block); }
+
+		~SharedLinearAllocator() = default;
+
+		SharedLinearAllocator(const SharedLinearAllocator&) = delete;
+		SharedLinearAllocator& operator=(const SharedLinearAllocator&) = delete;
+
+		void initialize(const AllocatedBlock block)
+		{
+			m_begin = (size_t)block.ptr;
+			m_last = (size_t)block.ptr + block.size;
+			m_end.store(m_begin, std::memory_order_relaxed);
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (size == 0)
+				return{ nullptr, 0 };
+
+			auto alignedSize = getAlignedSize(size, alignment);
+
+			size_t alignedPtr = 0;
+			auto end = m_end.load(std::memory_order_relaxed);
+			do
+			{
+				alignedPtr = getAlignedSize(end, alignment);
+				if (alignedPtr + alignedSize > m_last)
+					return{ nullptr, 0 };
+			} while (!m_end.compare_exchange_weak(end, alignedPtr + alignedSize, std::memory_order_relaxed));
+
+			return{ (u8*)alignedPtr, alignedSize };
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr != nullptr && getAlignedPtr(block.ptr, alignment) == block.ptr)
+			{
+				auto alignedSize = getAlignedSize(size, alignment);
+				if (alignedSize <= block.size)
+					return block;
+
+				// grow in place if the block is still the last one
+				auto end = (size_t)(block.ptr + block.size);
+				auto next = (size_t)block.ptr + alignedSize;
+				if (next <= m_last && m_end.compare_exchange_strong(end, next, std::memory_order_relaxed))
+					return{ block.ptr, alignedSize };
+			}
+
+			auto newBlock = allocate(size, alignment);
+			if (newBlock.ptr && block.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+				deallocate(block);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (block.ptr == nullptr)
+				return 0;
+
+			auto end = (size_t)(block.ptr + block.size);
+			return m_end.compare_exchange_strong(end, (size_t)block.ptr, std::memory_order_relaxed) ? 1 : 0;
+		}
+
+		void deallocateAll()
+		{
+			m_end.store(m_begin, std::memory_order_relaxed);
+		}
+
+		AllocatedBlock release()
+		{
+			AllocatedBlock block = { (u8*)m_begin, m_last - m_begin };
+			m_begin = m_last = 0;
+			m_end.store(0, std::memory_order_relaxed);
+			return block;
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			return ((size_t)block.ptr >= m_begin) && ((size_t)block.ptr < m_last);
+		}
+
+		size_t capacity() const { return m_last - m_begin; }
+		size_t size() const { return m_end.load(std::memory_order_relaxed) - m_begin; }
+	};
+}
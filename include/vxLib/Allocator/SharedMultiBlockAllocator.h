@@ -0,0 +1,283 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <vxLib/util/bitops.h>
+#include <atomic>
+#include <cstdio>
+#include <new>
+
+namespace vx
+{
+	/*
+	thread-safe version of MultiBlockAllocator, blocks are claimed with a cas on the 64 bit word holding them.
+	An allocation never crosses a word, so MAX_BLOCK_COUNT is limited to 64.
+	With MAX_BLOCK_COUNT == 1 this is the lock-free counterpart of BitmapBlock.
+	The bitmap lives at the start of the block passed to initialize, a set bit marks a free block.
+	initialize, release and deallocateAll must not run concurrently with other calls.
+
+	BLOCK_SIZE: size of allocation, needs to be aligned by ALIGNMENT
+	ALIGNMENT: alignment of blocks
+	MAX_BLOCK_COUNT: maximum amount of blocks used by an allocation
+	*/
+	template<size_t BLOCK_SIZE, size_t ALIGNMENT, size_t MAX_BLOCK_COUNT>
+	class SharedMultiBlockAllocator
+	{
+		static_assert(GetAlignedSize<BLOCK_SIZE, ALIGNMENT>::size == BLOCK_SIZE, "");
+		static_assert(MAX_BLOCK_COUNT > 0 && MAX_BLOCK_COUNT <= 64, "");
+
+		typedef std::atomic<u64> Word;
+
+		enum : size_t
+		{
+			BitsWord = 64,
+			BitsAlignment = (ALIGNMENT < __alignof(Word)) ? __alignof(Word) : ALIGNMENT
+		};
+
+		u8* m_firstBlock;
+		Word* m_bits;
+		size_t m_wordCount;
+		size_t m_blockCount;
+		std::atomic<size_t> m_remainingBlocks;
+		std::atomic<size_t> m_hint;
+		AllocatedBlock m_block;
+
+		static u64 getMask(size_t bit, size_t count)
+		{
+			return ((count == BitsWord) ? ~u64(0) : ((u64(1) << count) - 1)) << bit;
+		}
+
+		// bit i of the result is set if bits i..i+count-1 of x are set
+		static u64 findRuns(u64 x, size_t count)
+		{
+			while (count > 1)
+			{
+				auto s = count >> 1;
+				x = x & (x >> s);
+				count = count - s;
+			}
+
+			return x;
+		}
+
+		bool claim(size_t wordIndex, size_t blockCount, size_t* resultBlock)
+		{
+			auto &word = m_bits[wordIndex];
+			auto bits = word.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				auto runs = findRuns(bits, blockCount);
+				if (runs == 0)
+					return false;
+
+				auto bit = ntz64(runs);
+				if (word.compare_exchange_weak(bits, bits & ~getMask(bit, blockCount), std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					*resultBlock = wordIndex * BitsWord + bit;
+					return true;
+				}
+			}
+		}
+
+		void resetBits()
+		{
+			for (size_t i = 0; i < m_wordCount; ++i)
+			{
+				auto blocks = m_blockCount - i * BitsWord;
+				m_bits[i].store((blocks >= BitsWord) ? ~u64(0) : getMask(0, blocks), std::memory_order_relaxed);
+			}
+
+			m_remainingBlocks.store(m_blockCount, std::memory_order_relaxed);
+			m_hint.store(0, std::memory_order_relaxed);
+		}
+
+	public:
+		enum : size_t { MaxAllocSize = BLOCK_SIZE * MAX_BLOCK_COUNT };
+
+		SharedMultiBlockAllocator() :m_firstBlock(nullptr), m_bits(nullptr), m_wordCount(0), m_blockCount(0), m_remainingBlocks(0), m_hint(0), m_block() {}
+
+		explicit SharedMultiBlockAllocator(const AllocatedBlock block) :SharedMultiBlockAllocator() { initialize(block); }
+
+		SharedMultiBlockAllocator(const SharedMultiBlockAllocator&) = delete;
+		SharedMultiBlockAllocator& operator=(const SharedMultiBlockAllocator&) = delete;
+
+		~SharedMultiBlockAllocator() {}
+
+		void initialize(const AllocatedBlock block)
+		{
+			auto alignedPtr = getAlignedPtr(block.ptr, BitsAlignment);
+			auto offset = (size_t)(alignedPtr - block.ptr);
+			if (offset >= block.size)
+				return;
+
+			auto blockCount = (block.size - offset) / BLOCK_SIZE;
+			auto wordCount = (blockCount + BitsWord - 1) / BitsWord;
+			auto requiredBlocksForBits = (wordCount * sizeof(Word) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			if (requiredBlocksForBits >= blockCount)
+				return;
+
+			m_bits = (Word*)alignedPtr;
+			m_firstBlock = alignedPtr + requiredBlocksForBits * BLOCK_SIZE;
+			m_blockCount = blockCount - requiredBlocksForBits;
+			m_wordCount = (m_blockCount + BitsWord - 1) / BitsWord;
+			m_block = block;
+
+			for (size_t i = 0; i < m_wordCount; ++i)
+			{
+				new (&m_bits[i]) Word(0);
+			}
+
+			resetBits();
+		}
+
+		AllocatedBlock release()
+		{
+			auto block = m_block;
+
+			m_firstBlock = nullptr;
+			m_bits = nullptr;
+			m_wordCount = m_blockCount = 0;
+			m_remainingBlocks.store(0, std::memory_order_relaxed);
+			m_block.ptr = nullptr;
+			m_block.size = 0;
+
+			return block;
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (size == 0 || alignment > ALIGNMENT)
+				return{ nullptr, 0 };
+
+			auto blockCount = (getAlignedSize(size, alignment) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			if (blockCount > MAX_BLOCK_COUNT || blockCount > m_remainingBlocks.load(std::memory_order_relaxed))
+				return{ nullptr, 0 };
+
+			auto wordIndex = m_hint.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < m_wordCount; ++i)
+			{
+				size_t resultBlock = 0;
+				if (claim(wordIndex, blockCount, &resultBlock))
+				{
+					m_remainingBlocks.fetch_sub(blockCount, std::memory_order_relaxed);
+					m_hint.store(wordIndex, std::memory_order_relaxed);
+
+					return{ m_firstBlock + resultBlock * BLOCK_SIZE, blockCount * BLOCK_SIZE };
+				}
+
+				if (++wordIndex == m_wordCount)
+					wordIndex = 0;
+			}
+
+			return{ nullptr, 0 };
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			bool isAligned = (getAlignedPtr(block.ptr, alignment) == block.ptr);
+			auto alignedSize = getAlignedSize(size, alignment);
+			if (block.ptr && (block.size >= alignedSize) && isAligned)
+				return block;
+
+			if (block.ptr && isAligned)
+			{
+				auto blockIndex = (size_t)(block.ptr - m_firstBlock) / BLOCK_SIZE;
+				auto oldBlockCount = block.size / BLOCK_SIZE;
+				auto newBlockCount = (alignedSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+				// grow in place if the following blocks are free and in the same word
+				auto bit = blockIndex % BitsWord;
+				if (newBlockCount <= MAX_BLOCK_COUNT && bit + newBlockCount <= BitsWord)
+				{
+					auto mask = getMask(bit + oldBlockCount, newBlockCount - oldBlockCount);
+					auto &word = m_bits[blockIndex / BitsWord];
+					auto bits = word.load(std::memory_order_relaxed);
+					while ((bits & mask) == mask)
+					{
+						if (word.compare_exchange_weak(bits, bits & ~mask, std::memory_order_acquire, std::memory_order_relaxed))
+						{
+							m_remainingBlocks.fetch_sub(newBlockCount - oldBlockCount, std::memory_order_relaxed);
+							return{ block.ptr, newBlockCount * BLOCK_SIZE };
+						}
+					}
+				}
+			}
+
+			auto newBlock = allocate(size, alignment);
+			if (newBlock.ptr && block.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+				deallocate(block);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (block.ptr == nullptr || block.size == 0)
+				return 1;
+
+			VX_ASSERT(block.ptr >= m_firstBlock);
+
+			auto blockIndex = (size_t)(block.ptr - m_firstBlock) / BLOCK_SIZE;
+			VX_ASSERT(blockIndex < m_blockCount);
+
+			auto blockCount = (block.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			auto wordIndex = blockIndex / BitsWord;
+			m_bits[wordIndex].fetch_or(getMask(blockIndex % BitsWord, blockCount), std::memory_order_release);
+
+			m_remainingBlocks.fetch_add(blockCount, std::memory_order_relaxed);
+			m_hint.store(wordIndex, std::memory_order_relaxed);
+
+			return 1;
+		}
+
+		void deallocateAll()
+		{
+			if (m_bits)
+				resetBits();
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			auto last = m_firstBlock + BLOCK_SIZE * m_blockCount;
+			return (block.ptr >= m_firstBlock) && (block.ptr < last);
+		}
+
+		size_t getRemainingBlocks() const { return m_remainingBlocks.load(std::memory_order_relaxed); }
+
+		void print() const
+		{
+			printStatic();
+		}
+
+		static void printStatic()
+		{
+			printf("blocksize: %llu, alignment: %llu\n", (unsigned long long)BLOCK_SIZE, (unsigned long long)ALIGNMENT);
+		}
+	};
+}
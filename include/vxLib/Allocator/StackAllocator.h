@@ -79,6 +79,8 @@ namespace vx
 			else if (m_head == (block.ptr + block.size))
 			{
 				auto alignedSize = getAlignedSize(size, alignment);
+				if (block.ptr + alignedSize > m_last)
+					return{ nullptr, 0 };
 
 				newBlock = { block.ptr, alignedSize };
 				m_head = newBlock.ptr + newBlock.size;
@@ -87,6 +89,20 @@ namespace vx
 			return newBlock;
 		}
 
+		// only the last allocation can grow or shrink without moving
+		AllocatedBlock try_expand_in_place(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr == nullptr || m_head != block.ptr + block.size)
+				return{ nullptr, 0 };
+
+			auto alignedSize = getAlignedSize(size, alignment);
+			if (block.ptr + alignedSize > m_last)
+				return{ nullptr, 0 };
+
+			m_head = block.ptr + alignedSize;
+			return{ block.ptr, alignedSize };
+		}
+
 		u32 deallocate(const vx::AllocatedBlock block)
 		{
 			auto tmp = block.ptr + block.size;
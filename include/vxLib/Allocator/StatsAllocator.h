@@ -0,0 +1,375 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <vxLib/File.h>
+#include <vxLib/util/bitops.h>
+#include <atomic>
+#include <cstdio>
+#if defined(_VX_PLATFORM_WINDOWS)
+#include <intrin.h>
+#elif !defined(_VX_PLATFORM_ANDROID)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace vx
+{
+	enum class AllocatorTraceOp : u32
+	{
+		Allocate,
+		Reallocate,
+		Deallocate,
+		AllocateFailed
+	};
+
+	struct AllocatorTraceEntry
+	{
+		// cpu timestamp counter, steady_clock nanoseconds on Android
+		u64 timestamp;
+		u64 ptr;
+		u64 size;
+		AllocatorTraceOp op;
+		u32 padding;
+	};
+
+	// layout of the file written by StatsAllocator::dumpTrace, followed by entryCount AllocatorTraceEntry, oldest first
+	struct AllocatorTraceFileHeader
+	{
+		enum : u32 { Magic = 0x54415856, Version = 1 };
+
+		u32 magic;
+		u32 version;
+		u64 entryCount;
+	};
+
+	struct AllocatorStats
+	{
+		enum : u32 { HistogramSize = 32 };
+
+		u64 liveBytes;
+		u64 peakBytes;
+		u64 allocationCount;
+		u64 reallocationCount;
+		u64 deallocationCount;
+		u64 failedAllocations;
+		// allocations with a size in [2^(i-1), 2^i), the last bucket takes everything larger
+		u64 histogram[HistogramSize];
+	};
+
+	namespace detail
+	{
+		inline u64 getTraceTimestamp()
+		{
+#ifndef _VX_PLATFORM_ANDROID
+			return __rdtsc();
+#else
+			return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+		}
+
+		template<size_t TRACE_CAPACITY>
+		class AllocatorTrace
+		{
+			static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0, "trace capacity needs to be a power of two");
+
+			/*
+			every slot is a small seqlock, sequence is 2 * index + 1 while the writer of operation index fills it in
+			and 2 * index + 2 once it is done. A writer that wrapped around and a concurrent dump only see each
+			other as a sequence mismatch, dump skips those slots.
+			*/
+			struct Slot
+			{
+				std::atomic<u64> sequence;
+				std::atomic<u64> timestamp;
+				std::atomic<u64> ptr;
+				std::atomic<u64> size;
+				std::atomic<u32> op;
+			};
+
+			std::atomic<u64> m_index;
+			Slot m_slots[TRACE_CAPACITY];
+
+			bool readSlot(u64 index, AllocatorTraceEntry* entry) const
+			{
+				auto &slot = m_slots[index & (TRACE_CAPACITY - 1)];
+				auto sequence = slot.sequence.load(std::memory_order_acquire);
+				if (sequence != 2 * index + 2)
+					return false;
+
+				entry->timestamp = slot.timestamp.load(std::memory_order_relaxed);
+				entry->ptr = slot.ptr.load(std::memory_order_relaxed);
+				entry->size = slot.size.load(std::memory_order_relaxed);
+				entry->op = (AllocatorTraceOp)slot.op.load(std::memory_order_relaxed);
+				entry->padding = 0;
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+				return slot.sequence.load(std::memory_order_relaxed) == sequence;
+			}
+
+		public:
+			AllocatorTrace() :m_index(0)
+			{
+				for (auto &slot : m_slots)
+				{
+					slot.sequence.store(0, std::memory_order_relaxed);
+				}
+			}
+
+			void record(AllocatorTraceOp op, const u8* ptr, size_t size)
+			{
+				auto index = m_index.fetch_add(1, std::memory_order_relaxed);
+				auto &slot = m_slots[index & (TRACE_CAPACITY - 1)];
+
+				slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+
+				slot.timestamp.store(getTraceTimestamp(), std::memory_order_relaxed);
+				slot.ptr.store((u64)ptr, std::memory_order_relaxed);
+				slot.size.store(size, std::memory_order_relaxed);
+				slot.op.store((u32)op, std::memory_order_relaxed);
+
+				slot.sequence.store(2 * index + 2, std::memory_order_release);
+			}
+
+			// can run while other threads record, entries that are overwritten or unfinished during the dump are left out
+			bool dump(const char* fileName) const
+			{
+				File file;
+				if (!file.create(fileName, FileAccess::Write))
+					return false;
+
+				auto index = m_index.load(std::memory_order_acquire);
+				auto count = (index < TRACE_CAPACITY) ? index : TRACE_CAPACITY;
+
+				AllocatorTraceFileHeader header;
+				header.magic = AllocatorTraceFileHeader::Magic;
+				header.version = AllocatorTraceFileHeader::Version;
+				header.entryCount = 0;
+
+				bool result = file.write(header);
+				for (u64 i = index - count; result && i < index; ++i)
+				{
+					AllocatorTraceEntry entry;
+					if (!readSlot(i, &entry))
+						continue;
+
+					result = file.write(entry);
+					++header.entryCount;
+				}
+
+				// patch in the number of entries that made it
+				result = result && file.seek(0, FileSeekPosition::Begin) && file.write(header);
+
+				file.close();
+				return result;
+			}
+		};
+
+		template<>
+		class AllocatorTrace<0>
+		{
+		public:
+			void record(AllocatorTraceOp, const u8*, size_t) {}
+
+			bool dump(const char*) const { return false; }
+		};
+	}
+
+	/*
+	counts what Super hands out, the counters are updated with relaxed atomics and can be read from any thread.
+	TRACE_CAPACITY > 0 keeps the last TRACE_CAPACITY operations in a ring buffer that dumpTrace writes to a file.
+	*/
+	template<typename Super, size_t TRACE_CAPACITY>
+	class StatsAllocator : public Super
+	{
+		enum : u32 { HistogramSize = AllocatorStats::HistogramSize };
+
+		std::atomic<u64> m_liveBytes;
+		std::atomic<u64> m_peakBytes;
+		std::atomic<u64> m_allocationCount;
+		std::atomic<u64> m_reallocationCount;
+		std::atomic<u64> m_deallocationCount;
+		std::atomic<u64> m_failedAllocations;
+		std::atomic<u64> m_histogram[HistogramSize];
+		detail::AllocatorTrace<TRACE_CAPACITY> m_trace;
+
+		static u32 getBucket(size_t size)
+		{
+			if (size == 0)
+				return 0;
+
+			auto bucket = 64 - nlz64(size);
+			return (bucket < HistogramSize) ? bucket : HistogramSize - 1;
+		}
+
+		void addLiveBytes(size_t size)
+		{
+			auto live = m_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+			auto peak = m_peakBytes.load(std::memory_order_relaxed);
+			while (live > peak && !m_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		void onAllocate(const AllocatedBlock block, size_t size)
+		{
+			if (block.ptr == nullptr)
+			{
+				m_failedAllocations.fetch_add(1, std::memory_order_relaxed);
+				m_trace.record(AllocatorTraceOp::AllocateFailed, nullptr, size);
+				return;
+			}
+
+			m_allocationCount.fetch_add(1, std::memory_order_relaxed);
+			m_histogram[getBucket(size)].fetch_add(1, std::memory_order_relaxed);
+			addLiveBytes(block.size);
+			m_trace.record(AllocatorTraceOp::Allocate, block.ptr, block.size);
+		}
+
+		void resetCounters()
+		{
+			m_liveBytes.store(0, std::memory_order_relaxed);
+			m_peakBytes.store(0, std::memory_order_relaxed);
+			m_allocationCount.store(0, std::memory_order_relaxed);
+			m_reallocationCount.store(0, std::memory_order_relaxed);
+			m_deallocationCount.store(0, std::memory_order_relaxed);
+			m_failedAllocations.store(0, std::memory_order_relaxed);
+			for (u32 i = 0; i < HistogramSize; ++i)
+			{
+				m_histogram[i].store(0, std::memory_order_relaxed);
+			}
+		}
+
+	public:
+		StatsAllocator() :Super() { resetCounters(); }
+		explicit StatsAllocator(const AllocatedBlock block) :Super(block) { resetCounters(); }
+
+		StatsAllocator(const StatsAllocator&) = delete;
+		StatsAllocator& operator=(const StatsAllocator&) = delete;
+
+		~StatsAllocator() {}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			auto block = Super::allocate(size, alignment);
+			onAllocate(block, size);
+			return block;
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			auto newBlock = Super::reallocate(block, size, alignment);
+			// reallocating a null block is an allocation
+			if (block.ptr == nullptr)
+			{
+				onAllocate(newBlock, size);
+				return newBlock;
+			}
+
+			if (newBlock.ptr == nullptr)
+			{
+				m_failedAllocations.fetch_add(1, std::memory_order_relaxed);
+				m_trace.record(AllocatorTraceOp::AllocateFailed, block.ptr, size);
+				return newBlock;
+			}
+
+			m_reallocationCount.fetch_add(1, std::memory_order_relaxed);
+			m_liveBytes.fetch_sub(block.size, std::memory_order_relaxed);
+			addLiveBytes(newBlock.size);
+			m_trace.record(AllocatorTraceOp::Reallocate, newBlock.ptr, newBlock.size);
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			auto result = Super::deallocate(block);
+			if (result != 0)
+			{
+				m_deallocationCount.fetch_add(1, std::memory_order_relaxed);
+				m_liveBytes.fetch_sub(block.size, std::memory_order_relaxed);
+				m_trace.record(AllocatorTraceOp::Deallocate, block.ptr, block.size);
+			}
+
+			return result;
+		}
+
+		void deallocateAll()
+		{
+			Super::deallocateAll();
+			m_liveBytes.store(0, std::memory_order_relaxed);
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			return Super::contains(block);
+		}
+
+		AllocatorStats getStats() const
+		{
+			AllocatorStats stats;
+			stats.liveBytes = m_liveBytes.load(std::memory_order_relaxed);
+			stats.peakBytes = m_peakBytes.load(std::memory_order_relaxed);
+			stats.allocationCount = m_allocationCount.load(std::memory_order_relaxed);
+			stats.reallocationCount = m_reallocationCount.load(std::memory_order_relaxed);
+			stats.deallocationCount = m_deallocationCount.load(std::memory_order_relaxed);
+			stats.failedAllocations = m_failedAllocations.load(std::memory_order_relaxed);
+			for (u32 i = 0; i < HistogramSize; ++i)
+			{
+				stats.histogram[i] = m_histogram[i].load(std::memory_order_relaxed);
+			}
+
+			return stats;
+		}
+
+		void resetStats()
+		{
+			resetCounters();
+		}
+
+		bool dumpTrace(const char* fileName) const
+		{
+			return m_trace.dump(fileName);
+		}
+
+		void print() const
+		{
+			auto stats = getStats();
+			printf("live: %llu, peak: %llu, allocations: %llu, reallocations: %llu, deallocations: %llu, failed: %llu\n",
+				(unsigned long long)stats.liveBytes, (unsigned long long)stats.peakBytes,
+				(unsigned long long)stats.allocationCount, (unsigned long long)stats.reallocationCount,
+				(unsigned long long)stats.deallocationCount, (unsigned long long)stats.failedAllocations);
+
+			for (u32 i = 0; i < HistogramSize; ++i)
+			{
+				if (stats.histogram[i] != 0)
+					printf("  < %llu: %llu\n", 1ull << i, (unsigned long long)stats.histogram[i]);
+			}
+		}
+	};
+}
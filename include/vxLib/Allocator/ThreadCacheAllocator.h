@@ -0,0 +1,414 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/SharedAllocator.h>
+#include <vxLib/util/bitops.h>
+#include <new>
+
+namespace vx
+{
+	namespace detail
+	{
+		enum : u32 { ThreadCacheMaxSlots = 256, ThreadCacheNoSlot = 0xffffffff };
+
+		inline std::atomic<u64>* getThreadCacheSlotBits()
+		{
+			static std::atomic<u64> s_bits[ThreadCacheMaxSlots / 64];
+			return s_bits;
+		}
+
+		// slots are handed back when a thread exits, the next thread takes over its cache
+		struct ThreadCacheSlot
+		{
+			u32 index;
+
+			ThreadCacheSlot()
+				:index(ThreadCacheNoSlot)
+			{
+				auto bits = getThreadCacheSlotBits();
+				for (u32 i = 0; i < ThreadCacheMaxSlots / 64; ++i)
+				{
+					auto word = bits[i].load(std::memory_order_relaxed);
+					while (word != ~u64(0))
+					{
+						auto bit = ntz64(~word);
+						if (bits[i].compare_exchange_weak(word, word | (u64(1) << bit), std::memory_order_acquire, std::memory_order_relaxed))
+						{
+							index = i * 64 + bit;
+							return;
+						}
+					}
+				}
+			}
+
+			~ThreadCacheSlot()
+			{
+				if (index != ThreadCacheNoSlot)
+				{
+					getThreadCacheSlotBits()[index / 64].fetch_and(~(u64(1) << (index & 63)), std::memory_order_release);
+				}
+			}
+		};
+
+		template<size_t N>
+		struct ThreadCacheLog2
+		{
+			enum : size_t { value = 1 + ThreadCacheLog2<N / 2>::value };
+		};
+
+		template<>
+		struct ThreadCacheLog2<1>
+		{
+			enum : size_t { value = 0 };
+		};
+
+		inline u32 getThreadCacheSlot()
+		{
+			static thread_local ThreadCacheSlot t_slot;
+			return t_slot.index;
+		}
+	}
+
+	/*
+	per-thread cache in front of any allocator.
+	Every thread gets a magazine of up to MAGAZINE_SIZE blocks for each power of two size class in [MIN_SIZE, MAX_SIZE],
+	refills and flushes move MAGAZINE_SIZE / 2 blocks at once from/to Super, which is only touched under a spin lock.
+	Blocks freed by another thread are pushed onto the owning thread's mpsc queue and picked up on its next refill.
+	Each cached block starts with a header of ALIGNMENT bytes holding the owning thread and size class.
+	Requests that don't fit the biggest class or need an alignment above ALIGNMENT go straight to Super,
+	as do allocations from threads beyond MAX_THREAD_COUNT.
+	deallocateAll and release must not run concurrently with other calls.
+	*/
+	template<typename Super, size_t MIN_SIZE, size_t MAX_SIZE, size_t ALIGNMENT, size_t MAGAZINE_SIZE, size_t MAX_THREAD_COUNT>
+	class ThreadCacheAllocator : public Super
+	{
+		typedef detail::SharedAllocatorLockGuard LockGuard;
+
+		struct Header
+		{
+			u32 owner;
+			u32 sizeClass;
+		};
+
+		struct Node
+		{
+			Node* next;
+		};
+
+		enum : size_t
+		{
+			HeaderSize = ALIGNMENT,
+			BatchSize = MAGAZINE_SIZE / 2,
+			MinShift = detail::ThreadCacheLog2<MIN_SIZE>::value,
+			ClassCount = detail::ThreadCacheLog2<MAX_SIZE>::value - MinShift + 1,
+			MaxCachedSize = MAX_SIZE - HeaderSize
+		};
+
+		static_assert(ALIGNMENT >= sizeof(Header) && (ALIGNMENT & (ALIGNMENT - 1)) == 0, "");
+		static_assert((MIN_SIZE & (MIN_SIZE - 1)) == 0 && (MAX_SIZE & (MAX_SIZE - 1)) == 0, "size classes need to be powers of two");
+		static_assert(MIN_SIZE >= HeaderSize + sizeof(Node) && MIN_SIZE <= MAX_SIZE, "");
+		static_assert(BatchSize > 0, "");
+		static_assert(MAX_THREAD_COUNT <= detail::ThreadCacheMaxSlots, "");
+
+		struct Magazine
+		{
+			size_t count;
+			u8* blocks[MAGAZINE_SIZE];
+		};
+
+		struct ThreadCache
+		{
+			std::atomic<Node*> remoteFrees;
+			u8 padding[64 - sizeof(std::atomic<Node*>)];
+			Magazine magazines[ClassCount];
+		};
+
+		mutable detail::SharedAllocatorLock m_parentLock;
+		std::atomic<ThreadCache*> m_caches[MAX_THREAD_COUNT];
+
+		static size_t getClassSize(u32 sizeClass)
+		{
+			return size_t(MIN_SIZE) << sizeClass;
+		}
+
+		static u32 getSizeClass(size_t size)
+		{
+			size += HeaderSize;
+			if (size <= MIN_SIZE)
+				return 0;
+
+			return (64 - nlz64(size - 1)) - MinShift;
+		}
+
+		static Header* getHeader(u8* ptr)
+		{
+			return (Header*)(ptr - HeaderSize);
+		}
+
+		ThreadCache* getCache(u32 slot)
+		{
+			auto cache = m_caches[slot].load(std::memory_order_acquire);
+			if (cache != nullptr)
+				return cache;
+
+			AllocatedBlock block;
+			{
+				LockGuard guard(&m_parentLock);
+				block = Super::allocate(sizeof(ThreadCache), ALIGNMENT);
+			}
+
+			if (block.ptr == nullptr)
+				return nullptr;
+
+			cache = (ThreadCache*)block.ptr;
+			new (&cache->remoteFrees) std::atomic<Node*>(nullptr);
+			for (u32 i = 0; i < ClassCount; ++i)
+			{
+				cache->magazines[i].count = 0;
+			}
+
+			m_caches[slot].store(cache, std::memory_order_release);
+			return cache;
+		}
+
+		void flush(Magazine* magazine, u32 sizeClass, size_t count)
+		{
+			auto classSize = getClassSize(sizeClass);
+
+			LockGuard guard(&m_parentLock);
+			for (size_t i = 0; i < count; ++i)
+			{
+				Super::deallocate({ magazine->blocks[--magazine->count], classSize });
+			}
+		}
+
+		void refill(Magazine* magazine, u32 sizeClass, u32 owner)
+		{
+			auto classSize = getClassSize(sizeClass);
+
+			LockGuard guard(&m_parentLock);
+			for (size_t i = 0; i < BatchSize; ++i)
+			{
+				auto block = Super::allocate(classSize, ALIGNMENT);
+				if (block.ptr == nullptr)
+					break;
+
+				auto header = (Header*)block.ptr;
+				header->owner = owner;
+				header->sizeClass = sizeClass;
+
+				magazine->blocks[magazine->count++] = block.ptr;
+			}
+		}
+
+		void pushLocal(ThreadCache* cache, u8* headerPtr, u32 sizeClass)
+		{
+			auto magazine = &cache->magazines[sizeClass];
+			if (magazine->count == MAGAZINE_SIZE)
+			{
+				flush(magazine, sizeClass, BatchSize);
+			}
+
+			magazine->blocks[magazine->count++] = headerPtr;
+		}
+
+		void drainRemoteFrees(ThreadCache* cache)
+		{
+			auto node = cache->remoteFrees.exchange(nullptr, std::memory_order_acquire);
+			while (node != nullptr)
+			{
+				auto next = node->next;
+				auto ptr = (u8*)node;
+				pushLocal(cache, ptr - HeaderSize, getHeader(ptr)->sizeClass);
+				node = next;
+			}
+		}
+
+		AllocatedBlock allocateUncached(size_t size, size_t alignment)
+		{
+			// keep the returned size above the cached sizes so deallocate can tell them apart
+			if (size <= MaxCachedSize)
+				size = MaxCachedSize + 1;
+
+			LockGuard guard(&m_parentLock);
+			return Super::allocate(size, alignment);
+		}
+
+		void clearCaches()
+		{
+			for (size_t i = 0; i < MAX_THREAD_COUNT; ++i)
+			{
+				m_caches[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		void releaseCaches()
+		{
+			for (size_t i = 0; i < MAX_THREAD_COUNT; ++i)
+			{
+				auto cache = m_caches[i].load(std::memory_order_relaxed);
+				if (cache == nullptr)
+					continue;
+
+				drainRemoteFrees(cache);
+				for (u32 j = 0; j < ClassCount; ++j)
+				{
+					flush(&cache->magazines[j], j, cache->magazines[j].count);
+				}
+
+				Super::deallocate({ (u8*)cache, sizeof(ThreadCache) });
+				m_caches[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+	public:
+		ThreadCacheAllocator() :Super(), m_parentLock() { clearCaches(); }
+		explicit ThreadCacheAllocator(const AllocatedBlock block) :Super(block), m_parentLock() { clearCaches(); }
+
+		ThreadCacheAllocator(const ThreadCacheAllocator&) = delete;
+		ThreadCacheAllocator& operator=(const ThreadCacheAllocator&) = delete;
+
+		~ThreadCacheAllocator()
+		{
+			releaseCaches();
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (size == 0)
+				return{ nullptr, 0 };
+
+			if (size > MaxCachedSize || alignment > ALIGNMENT)
+				return allocateUncached(size, alignment);
+
+			auto slot = detail::getThreadCacheSlot();
+			auto cache = (slot < MAX_THREAD_COUNT) ? getCache(slot) : nullptr;
+			if (cache == nullptr)
+				return allocateUncached(size, alignment);
+
+			auto sizeClass = getSizeClass(size);
+			auto magazine = &cache->magazines[sizeClass];
+			if (magazine->count == 0)
+			{
+				drainRemoteFrees(cache);
+				if (magazine->count == 0)
+				{
+					refill(magazine, sizeClass, slot);
+					if (magazine->count == 0)
+						return{ nullptr, 0 };
+				}
+			}
+
+			auto ptr = magazine->blocks[--magazine->count];
+			return{ ptr + HeaderSize, getClassSize(sizeClass) - HeaderSize };
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr && (block.size >= size) && (getAlignedPtr(block.ptr, alignment) == block.ptr))
+				return block;
+
+			auto newBlock = allocate(size, alignment);
+			if (newBlock.ptr && block.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, block.size);
+				deallocate(block);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (block.ptr == nullptr)
+				return 0;
+
+			if (block.size > MaxCachedSize)
+			{
+				LockGuard guard(&m_parentLock);
+				return Super::deallocate(block);
+			}
+
+			auto header = getHeader(block.ptr);
+			auto owner = header->owner;
+			auto slot = detail::getThreadCacheSlot();
+			if (owner == slot)
+			{
+				pushLocal(m_caches[slot].load(std::memory_order_relaxed), (u8*)header, header->sizeClass);
+				return 1;
+			}
+
+			auto cache = m_caches[owner].load(std::memory_order_acquire);
+			auto node = (Node*)block.ptr;
+			auto head = cache->remoteFrees.load(std::memory_order_relaxed);
+			do
+			{
+				node->next = head;
+			} while (!cache->remoteFrees.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+
+			return 1;
+		}
+
+		// returns the cached blocks of the calling thread to Super, call before a worker thread exits
+		void flushThreadCache()
+		{
+			auto slot = detail::getThreadCacheSlot();
+			if (slot >= MAX_THREAD_COUNT)
+				return;
+
+			auto cache = m_caches[slot].load(std::memory_order_relaxed);
+			if (cache == nullptr)
+				return;
+
+			drainRemoteFrees(cache);
+			for (u32 i = 0; i < ClassCount; ++i)
+			{
+				flush(&cache->magazines[i], i, cache->magazines[i].count);
+			}
+		}
+
+		void deallocateAll()
+		{
+			releaseCaches();
+			Super::deallocateAll();
+		}
+
+		AllocatedBlock release()
+		{
+			releaseCaches();
+			return Super::release();
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			LockGuard guard(&m_parentLock);
+			if (block.size > MaxCachedSize)
+				return Super::contains(block);
+
+			return Super::contains({ block.ptr - HeaderSize, block.size + HeaderSize });
+		}
+	};
+}
@@ -0,0 +1,403 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <vxLib/util/bitops.h>
+#include <cstdio>
+
+namespace vx
+{
+	namespace detail
+	{
+		struct TlsfBlockHeader
+		{
+			TlsfBlockHeader* prevPhys;
+			size_t size;
+			// only valid while the block is free, overlaps the user data
+			TlsfBlockHeader* nextFree;
+			TlsfBlockHeader* prevFree;
+		};
+	}
+
+	/*
+	two-level segregated fit allocator, allocate and deallocate are O(1).
+	The first level splits sizes by powers of two, the second level splits each power of two into 32 linear ranges.
+	Free lists and bitmaps live at the start of the block passed to initialize.
+	Blocks are 16 byte aligned, larger alignments are served by splitting off a leading free block.
+	*/
+	class TlsfAllocator
+	{
+		typedef detail::TlsfBlockHeader BlockHeader;
+
+		enum : size_t
+		{
+			AlignLog2 = 4,
+			AlignSize = size_t(1) << AlignLog2,
+			SlLog2 = 5,
+			SlCount = size_t(1) << SlLog2,
+			FlShift = SlLog2 + AlignLog2,
+			FlMax = 40,
+			FlCount = FlMax - FlShift + 1,
+			SmallBlockSize = size_t(1) << FlShift,
+			// prevPhys and size
+			BlockOverhead = sizeof(BlockHeader*) + sizeof(size_t),
+			MinBlockSize = sizeof(BlockHeader) - BlockOverhead,
+			MaxBlockSize = size_t(1) << FlMax,
+			FreeBit = 1
+		};
+
+		static_assert(BlockOverhead == AlignSize, "");
+
+		struct Control
+		{
+			u32 flBitmap;
+			u32 slBitmap[FlCount];
+			BlockHeader* blocks[FlCount][SlCount];
+		};
+
+		Control* m_control;
+		u8* m_poolBegin;
+		u8* m_poolEnd;
+		AllocatedBlock m_block;
+
+		static size_t getSize(const BlockHeader* block) { return block->size & ~size_t(FreeBit); }
+		static bool isFree(const BlockHeader* block) { return (block->size & FreeBit) != 0; }
+		static void setFree(BlockHeader* block) { block->size |= FreeBit; }
+		static void setUsed(BlockHeader* block) { block->size &= ~size_t(FreeBit); }
+		static u8* getPtr(BlockHeader* block) { return (u8*)block + BlockOverhead; }
+		static BlockHeader* getBlock(u8* ptr) { return (BlockHeader*)(ptr - BlockOverhead); }
+		static BlockHeader* getNext(BlockHeader* block) { return (BlockHeader*)(getPtr(block) + getSize(block)); }
+
+		static u32 fls(size_t x) { return 63 - nlz64(x); }
+
+		static void mappingInsert(size_t size, u32* fl, u32* sl)
+		{
+			if (size < SmallBlockSize)
+			{
+				*fl = 0;
+				*sl = (u32)(size / (SmallBlockSize / SlCount));
+			}
+			else
+			{
+				auto f = fls(size);
+				*sl = (u32)(size >> (f - SlLog2)) ^ (u32)SlCount;
+				*fl = f - (FlShift - 1);
+			}
+		}
+
+		// rounds up to the next list so every block in it is large enough
+		static void mappingSearch(size_t size, u32* fl, u32* sl)
+		{
+			if (size >= SmallBlockSize)
+			{
+				size += (size_t(1) << (fls(size) - SlLog2)) - 1;
+			}
+
+			mappingInsert(size, fl, sl);
+		}
+
+		BlockHeader* findSuitable(u32* fl, u32* sl)
+		{
+			auto slMap = m_control->slBitmap[*fl] & (~u32(0) << *sl);
+			if (slMap == 0)
+			{
+				auto flMap = (*fl + 1 < 32) ? (m_control->flBitmap & (~u32(0) << (*fl + 1))) : 0;
+				if (flMap == 0)
+					return nullptr;
+
+				*fl = ntz64(flMap);
+				slMap = m_control->slBitmap[*fl];
+			}
+
+			*sl = ntz64(slMap);
+			return m_control->blocks[*fl][*sl];
+		}
+
+		void removeFree(BlockHeader* block, u32 fl, u32 sl)
+		{
+			auto prev = block->prevFree;
+			auto next = block->nextFree;
+			if (next)
+				next->prevFree = prev;
+			if (prev)
+				prev->nextFree = next;
+
+			if (m_control->blocks[fl][sl] == block)
+			{
+				m_control->blocks[fl][sl] = next;
+				if (next == nullptr)
+				{
+					m_control->slBitmap[fl] &= ~(u32(1) << sl);
+					if (m_control->slBitmap[fl] == 0)
+						m_control->flBitmap &= ~(u32(1) << fl);
+				}
+			}
+		}
+
+		void removeFree(BlockHeader* block)
+		{
+			u32 fl, sl;
+			mappingInsert(getSize(block), &fl, &sl);
+			removeFree(block, fl, sl);
+		}
+
+		void insertFree(BlockHeader* block)
+		{
+			u32 fl, sl;
+			mappingInsert(getSize(block), &fl, &sl);
+
+			auto head = m_control->blocks[fl][sl];
+			block->nextFree = head;
+			block->prevFree = nullptr;
+			if (head)
+				head->prevFree = block;
+
+			m_control->blocks[fl][sl] = block;
+			m_control->slBitmap[fl] |= u32(1) << sl;
+			m_control->flBitmap |= u32(1) << fl;
+		}
+
+		// merges with free neighbours and puts the block into its list
+		void releaseBlock(BlockHeader* block)
+		{
+			setFree(block);
+
+			auto next = getNext(block);
+			if (isFree(next))
+			{
+				removeFree(next);
+				block->size += BlockOverhead + getSize(next);
+				getNext(block)->prevPhys = block;
+			}
+
+			auto prev = block->prevPhys;
+			if (prev && isFree(prev))
+			{
+				removeFree(prev);
+				prev->size += BlockOverhead + getSize(block);
+				getNext(prev)->prevPhys = prev;
+				block = prev;
+			}
+
+			insertFree(block);
+		}
+
+		// splits a used block, the remainder is released
+		void trimTrailing(BlockHeader* block, size_t size)
+		{
+			auto blockSize = getSize(block);
+			if (blockSize < size + BlockOverhead + MinBlockSize)
+				return;
+
+			auto rest = (BlockHeader*)(getPtr(block) + size);
+			rest->prevPhys = block;
+			rest->size = blockSize - size - BlockOverhead;
+			block->size = size | (block->size & FreeBit);
+			getNext(rest)->prevPhys = rest;
+
+			releaseBlock(rest);
+		}
+
+		static size_t adjustSize(size_t size)
+		{
+			size = getAlignedSize(size, AlignSize);
+			return (size < MinBlockSize) ? size_t(MinBlockSize) : size;
+		}
+
+		void initializePool()
+		{
+			::memset(m_control, 0, sizeof(Control));
+
+			auto poolSize = (size_t)(m_poolEnd - m_poolBegin);
+			auto block = (BlockHeader*)m_poolBegin;
+			block->prevPhys = nullptr;
+			block->size = poolSize - 2 * BlockOverhead;
+			if (block->size > MaxBlockSize - AlignSize)
+				block->size = MaxBlockSize - AlignSize;
+
+			// zero sized used block at the end stops merging
+			auto sentinel = getNext(block);
+			sentinel->prevPhys = block;
+			sentinel->size = 0;
+
+			setFree(block);
+			insertFree(block);
+		}
+
+	public:
+		TlsfAllocator() :m_control(nullptr), m_poolBegin(nullptr), m_poolEnd(nullptr), m_block() {}
+
+		explicit TlsfAllocator(const AllocatedBlock block) :TlsfAllocator() { initialize(block); }
+
+		TlsfAllocator(const TlsfAllocator&) = delete;
+		TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+		~TlsfAllocator() {}
+
+		void initialize(const AllocatedBlock block)
+		{
+			auto control = getAlignedPtr(block.ptr, AlignSize);
+			auto poolBegin = getAlignedPtr(control + sizeof(Control), AlignSize);
+			auto poolEnd = (u8*)((size_t)(block.ptr + block.size) & ~(size_t(AlignSize) - 1));
+			if (poolEnd <= poolBegin || (size_t)(poolEnd - poolBegin) < 2 * BlockOverhead + MinBlockSize)
+				return;
+
+			m_control = (Control*)control;
+			m_poolBegin = poolBegin;
+			m_poolEnd = poolEnd;
+			m_block = block;
+
+			initializePool();
+		}
+
+		AllocatedBlock release()
+		{
+			auto block = m_block;
+
+			m_control = nullptr;
+			m_poolBegin = m_poolEnd = nullptr;
+			m_block.ptr = nullptr;
+			m_block.size = 0;
+
+			return block;
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (size == 0 || m_control == nullptr || size > MaxBlockSize / 2)
+				return{ nullptr, 0 };
+
+			auto adjustedSize = adjustSize(size);
+
+			// room for a leading free block in front of the aligned pointer
+			auto searchSize = adjustedSize;
+			if (alignment > AlignSize)
+				searchSize += alignment + BlockOverhead + MinBlockSize;
+
+			u32 fl, sl;
+			mappingSearch(searchSize, &fl, &sl);
+			if (fl >= FlCount)
+				return{ nullptr, 0 };
+
+			auto block = findSuitable(&fl, &sl);
+			if (block == nullptr)
+				return{ nullptr, 0 };
+
+			removeFree(block, fl, sl);
+			setUsed(block);
+
+			if (alignment > AlignSize)
+			{
+				auto ptr = getPtr(block);
+				auto aligned = getAlignedPtr(ptr, alignment);
+				if (aligned != ptr)
+				{
+					if ((size_t)(aligned - ptr) < BlockOverhead + MinBlockSize)
+						aligned = getAlignedPtr(ptr + BlockOverhead + MinBlockSize, alignment);
+
+					// split off the leading part as a free block
+					auto gap = (size_t)(aligned - ptr);
+					auto alignedBlock = getBlock(aligned);
+					alignedBlock->prevPhys = block;
+					alignedBlock->size = getSize(block) - gap;
+					getNext(alignedBlock)->prevPhys = alignedBlock;
+
+					block->size = gap - BlockOverhead;
+					releaseBlock(block);
+
+					block = alignedBlock;
+				}
+			}
+
+			trimTrailing(block, adjustedSize);
+
+			return{ getPtr(block), getSize(block) };
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr == nullptr)
+				return allocate(size, alignment);
+
+			auto header = getBlock(block.ptr);
+			auto adjustedSize = adjustSize(size);
+			if (getAlignedPtr(block.ptr, alignment) == block.ptr && size <= MaxBlockSize / 2)
+			{
+				auto currentSize = getSize(header);
+				if (currentSize >= adjustedSize)
+					return{ block.ptr, currentSize };
+
+				// grow into the next block if it is free
+				auto next = getNext(header);
+				if (isFree(next) && currentSize + BlockOverhead + getSize(next) >= adjustedSize)
+				{
+					removeFree(next);
+					header->size += BlockOverhead + getSize(next);
+					getNext(header)->prevPhys = header;
+
+					trimTrailing(header, adjustedSize);
+					return{ block.ptr, getSize(header) };
+				}
+			}
+
+			auto newBlock = allocate(size, alignment);
+			if (newBlock.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+				deallocate(block);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (block.ptr == nullptr)
+				return 0;
+
+			VX_ASSERT(contains(block));
+
+			releaseBlock(getBlock(block.ptr));
+			return 1;
+		}
+
+		void deallocateAll()
+		{
+			if (m_control)
+				initializePool();
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			return (block.ptr >= m_poolBegin) && (block.ptr < m_poolEnd);
+		}
+
+		void print() const
+		{
+			printf("tlsf pool: %llu bytes\n", (unsigned long long)(m_poolEnd - m_poolBegin));
+		}
+	};
+}
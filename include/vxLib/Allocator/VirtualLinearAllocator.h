@@ -0,0 +1,217 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <vxLib/Allocator/VirtualMemory.h>
+
+namespace vx
+{
+	/*
+	linear allocator over a reserved virtual address range, pages are committed as the head moves forward.
+	deallocate works in lifo order, so this doubles as a growable stack allocator.
+	deallocateAll decommits everything above the high-water mark of the last cycle
+	once that mark drops below half of the committed memory.
+	*/
+	class VirtualLinearAllocator
+	{
+		u8* m_begin;
+		u8* m_head;
+		u8* m_committed;
+		u8* m_last;
+		u8* m_highWater;
+		size_t m_commitSize;
+
+		bool commit(u8* next)
+		{
+			if (next <= m_committed)
+				return true;
+
+			if (next > m_last)
+				return false;
+
+			auto newCommitted = (u8*)getAlignedSize((size_t)next, m_commitSize);
+			if (newCommitted > m_last)
+				newCommitted = m_last;
+
+			if (!commitVirtualMemory(m_committed, newCommitted - m_committed))
+				return false;
+
+			m_committed = newCommitted;
+			return true;
+		}
+
+	public:
+		VirtualLinearAllocator() :m_begin(nullptr), m_head(nullptr), m_committed(nullptr), m_last(nullptr), m_highWater(nullptr), m_commitSize(0) {}
+
+		// reserveSize is rounded up to commitSize, which is rounded up to the page size
+		explicit VirtualLinearAllocator(size_t reserveSize, size_t commitSize = 64 KBYTE)
+			:VirtualLinearAllocator()
+		{
+			initialize(reserveSize, commitSize);
+		}
+
+		VirtualLinearAllocator(const VirtualLinearAllocator&) = delete;
+
+		VirtualLinearAllocator(VirtualLinearAllocator &&rhs)
+			:VirtualLinearAllocator()
+		{
+			swap(rhs);
+		}
+
+		~VirtualLinearAllocator()
+		{
+			release();
+		}
+
+		VirtualLinearAllocator& operator=(const VirtualLinearAllocator&) = delete;
+
+		VirtualLinearAllocator& operator=(VirtualLinearAllocator &&rhs)
+		{
+			if (this != &rhs)
+			{
+				swap(rhs);
+			}
+			return *this;
+		}
+
+		void swap(VirtualLinearAllocator &rhs)
+		{
+			std::swap(m_begin, rhs.m_begin);
+			std::swap(m_head, rhs.m_head);
+			std::swap(m_committed, rhs.m_committed);
+			std::swap(m_last, rhs.m_last);
+			std::swap(m_highWater, rhs.m_highWater);
+			std::swap(m_commitSize, rhs.m_commitSize);
+		}
+
+		bool initialize(size_t reserveSize, size_t commitSize = 64 KBYTE)
+		{
+			release();
+
+			commitSize = getAlignedSize(commitSize, getVirtualMemoryPageSize());
+			reserveSize = getAlignedSize(reserveSize, commitSize);
+
+			auto ptr = reserveVirtualMemory(reserveSize);
+			if (ptr == nullptr)
+				return false;
+
+			m_begin = m_head = m_committed = m_highWater = ptr;
+			m_last = ptr + reserveSize;
+			m_commitSize = commitSize;
+
+			return true;
+		}
+
+		AllocatedBlock allocate(size_t size, size_t alignment)
+		{
+			if (size == 0)
+				return{ nullptr, 0 };
+
+			auto alignedPtr = getAlignedPtr(m_head, alignment);
+			auto alignedSize = getAlignedSize(size, alignment);
+
+			auto next = alignedPtr + alignedSize;
+			if (next > m_last || !commit(next))
+				return{ nullptr, 0 };
+
+			m_head = next;
+			if (m_head > m_highWater)
+				m_highWater = m_head;
+
+			return{ alignedPtr, alignedSize };
+		}
+
+		AllocatedBlock reallocate(const AllocatedBlock block, size_t size, size_t alignment)
+		{
+			if (block.ptr != nullptr &&
+				getAlignedPtr(block.ptr, alignment) == block.ptr &&
+				m_head == block.ptr + block.size)
+			{
+				auto alignedSize = getAlignedSize(size, alignment);
+				auto next = block.ptr + alignedSize;
+				if (next > m_last || !commit(next))
+					return{ nullptr, 0 };
+
+				m_head = next;
+				if (m_head > m_highWater)
+					m_highWater = m_head;
+
+				return{ block.ptr, alignedSize };
+			}
+
+			auto newBlock = allocate(size, alignment);
+			if (newBlock.ptr && block.ptr)
+			{
+				::memcpy(newBlock.ptr, block.ptr, (block.size < newBlock.size) ? block.size : newBlock.size);
+			}
+
+			return newBlock;
+		}
+
+		u32 deallocate(const AllocatedBlock block)
+		{
+			if (block.ptr != nullptr && m_head == block.ptr + block.size)
+			{
+				m_head = block.ptr;
+				return 1;
+			}
+
+			return 0;
+		}
+
+		void deallocateAll()
+		{
+			auto keep = (u8*)getAlignedSize((size_t)m_highWater, m_commitSize);
+			if ((size_t)(keep - m_begin) < (size_t)(m_committed - m_begin) / 2)
+			{
+				decommitVirtualMemory(keep, m_committed - keep);
+				m_committed = keep;
+			}
+
+			m_head = m_highWater = m_begin;
+		}
+
+		AllocatedBlock release()
+		{
+			if (m_begin)
+			{
+				releaseVirtualMemory(m_begin, m_last - m_begin);
+			}
+
+			m_begin = m_head = m_committed = m_last = m_highWater = nullptr;
+			return{ nullptr, 0 };
+		}
+
+		bool contains(const AllocatedBlock block) const
+		{
+			return (block.ptr >= m_begin) && (block.ptr < m_last);
+		}
+
+		size_t capacity() const { return m_last - m_begin; }
+		size_t size() const { return m_head - m_begin; }
+		size_t committedSize() const { return m_committed - m_begin; }
+	};
+}
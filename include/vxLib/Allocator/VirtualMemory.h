@@ -0,0 +1,64 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/types.h>
+
+namespace vx
+{
+	/*
+	thin wrapper over the os virtual memory api.
+	Reserved ranges have no backing memory until they are committed, sizes and pointers need to be multiples of getVirtualMemoryPageSize().
+	*/
+	size_t getVirtualMemoryPageSize();
+
+	// returns nullptr on failure
+	u8* reserveVirtualMemory(size_t size);
+	bool commitVirtualMemory(u8* ptr, size_t size);
+	// the range stays reserved but gives its physical pages back to the os
+	void decommitVirtualMemory(u8* ptr, size_t size);
+	void releaseVirtualMemory(u8* ptr, size_t size);
+
+	enum class PageType : u32
+	{
+		Default,
+		// 2 MiB aligned mapping with MADV_HUGEPAGE, the kernel backs it with huge pages when it can
+		TransparentHuge,
+		// MAP_HUGETLB / MEM_LARGE_PAGES, falls back to TransparentHuge if no huge pages are available
+		Huge
+	};
+
+	enum : s32 { AnyNumaNode = -1 };
+
+	// size the page allocator rounds requests of the given type to
+	size_t getPageSize(PageType type);
+
+	// committed memory bound to numaNode unless it is AnyNumaNode, size needs to be a multiple of getPageSize(type).
+	// Returns nullptr if the pages cannot be bound to numaNode.
+	u8* allocatePages(size_t size, PageType type, s32 numaNode);
+	// keeps the contents up to the smaller size, the pages may move
+	u8* reallocatePages(u8* ptr, size_t size, size_t newSize, PageType type, s32 numaNode);
+	void deallocatePages(u8* ptr, size_t size);
+}
@@ -2,6 +2,9 @@
 
 #include <vxLib/Container/StringArray.h>
 #include <atomic>
+#ifndef _VX_PLATFORM_WINDOWS
+#include <mm_malloc.h>
+#endif
 #include <algorithm>
 
 namespace vx
@@ -158,14 +161,24 @@ namespace vx
 		static void initialize()
 		{
 			if(s_data == nullptr)
+			{
+#ifdef _VX_PLATFORM_WINDOWS
 				s_data = (ArrayStats*)_aligned_malloc(sizeof(ArrayStats) * CAPACITY, __alignof(ArrayStats));
+#else
+				s_data = (ArrayStats*)_mm_malloc(sizeof(ArrayStats) * CAPACITY, __alignof(ArrayStats));
+#endif
+			}
 		}
 
 		static void shutdown()
 		{
 			if (s_data)
 			{
+#ifdef _VX_PLATFORM_WINDOWS
 				_aligned_free(s_data);
+#else
+				_mm_free(s_data);
+#endif
 				s_data = nullptr;
 			}
 		}
@@ -57,7 +57,7 @@ namespace vx
 			u32 result = 0;
 			if (m_end < m_last)
 			{
-				new (m_end++) value_type{ std::forward<Args>(args).. };
+				new (m_end++) value_type{ std::forward<Args>(args)... };
 				result = 1;
 			}
 			return result;
@@ -70,7 +70,7 @@ namespace vx
 
 		void clear()
 		{
-			vx::destruct(begin(), end());
+			vx::destroy_n(m_begin, m_end - m_begin);
 			m_end = m_begin;
 		}
 
@@ -83,7 +83,8 @@ namespace vx
 			auto idx = p - bg;
 			vx::destruct(p);
 
-			vx::move(p + 1, m_end--, p);
+			--m_end;
+			vx::relocate_n(p + 1, m_end - p, p);
 
 			return (bg + idx);
 		}
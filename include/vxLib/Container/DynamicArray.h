@@ -28,15 +28,28 @@ SOFTWARE.
 #include <vxLib/TypeInfo.h>
 #include <vxLib/ArrayAnalyzer.h>
 #include <vxLib/Allocator/Mallocator.h>
+#include <vxLib/Container/GrowthPolicy.h>
+#include <vxLib/algorithm.h>
+#include <vxLib/type_traits.h>
 
 namespace vx
 {
-	template<typename T, typename Allocator = Mallocator>
+	/*
+	GrowthPolicy decides the new capacity when push_back runs out of space, see GrowthPolicy.h.
+	Growing first asks the allocator to extend the block in place, then uses reallocate for trivially relocatable
+	types and allocate, move and destroy for everything else.
+	*/
+	template<typename T, typename Allocator = Mallocator, typename GrowthPolicy = GrowthPolicyDouble>
 	class DynamicArray : public ArrayBase<T>
 	{
 		typedef Allocator MyAllocator;
+		typedef GrowthPolicy MyGrowthPolicy;
 		typedef ArrayBase<T> MyBase;
 
+		using MyBase::m_begin;
+		using MyBase::m_end;
+		using MyBase::m_last;
+
 		VX_TYPE_INFO;
 
 		size_t m_blockSize;
@@ -45,6 +58,42 @@ namespace vx
 		ArrayStats m_arrayStats;
 #endif
 
+		AllocatedBlock growBlock(size_t c)
+		{
+			const AllocatedBlock oldBlock = { reinterpret_cast<u8*>(m_begin), m_blockSize };
+			auto newSize = sizeof(value_type) * c;
+
+			if (oldBlock.ptr == nullptr)
+				return m_allocator.allocate(newSize, __alignof(value_type));
+
+			auto newBlock = tryExpandInPlace(m_allocator, oldBlock, newSize, __alignof(value_type));
+			if (newBlock.ptr != nullptr)
+				return newBlock;
+
+			return relocateBlock(oldBlock, newSize, vx::is_trivially_relocatable<value_type>());
+		}
+
+		AllocatedBlock relocateBlock(const AllocatedBlock oldBlock, size_t newSize, std::true_type)
+		{
+			return m_allocator.reallocate(oldBlock, newSize, __alignof(value_type));
+		}
+
+		AllocatedBlock relocateBlock(const AllocatedBlock oldBlock, size_t newSize, std::false_type)
+		{
+			auto newBlock = m_allocator.allocate(newSize, __alignof(value_type));
+			if (newBlock.ptr != nullptr)
+			{
+				vx::relocate_n(m_begin, m_end - m_begin, reinterpret_cast<pointer>(newBlock.ptr));
+				m_allocator.deallocate(oldBlock);
+			}
+			return newBlock;
+		}
+
+		bool grow(size_t required)
+		{
+			return reserve(MyGrowthPolicy::getCapacity(capacity(), required, sizeof(value_type)));
+		}
+
 	public:
 		typedef typename MyBase::value_type value_type;
 		typedef typename MyBase::pointer pointer;
@@ -55,6 +104,12 @@ namespace vx
 		typedef typename MyBase::iterator iterator;
 		typedef typename MyBase::const_iterator const_iterator;
 
+		using MyBase::begin;
+		using MyBase::end;
+		using MyBase::size;
+		using MyBase::capacity;
+		using MyBase::clear;
+
 		DynamicArray() :MyBase(nullptr, nullptr), m_blockSize(0), m_allocator() { VX_REGISTER_ANALYZER; }
 
 		explicit DynamicArray(MyAllocator &&allocator)
@@ -166,23 +221,26 @@ namespace vx
 			}
 		}
 
-		void resize(size_t sz)
+		bool resize(size_t sz)
 		{
 			auto currentSize = size();
 			if (currentSize >= sz)
-				return;
+				return true;
 
-			reserve(sz);
+			if (!reserve(sz))
+				return false;
 
-			auto d = sz - currentSize;
-			while (d)
-			{
-				push_back(value_type{});
-				--d;
-			}
+			vx::uninitialized_default_n(m_end, sz - currentSize);
+			m_end = m_begin + sz;
+
+#ifdef _VX_ARRAY_ANALYZER
+			m_arrayStats.updateMaxSize(static_cast<u32>(size()));
+#endif
+			return true;
 		}
 
-		void reserve(size_t c)
+		// returns false and keeps the old block when the allocator is out of memory
+		bool reserve(size_t c)
 		{
 			auto currentCapacity = capacity();
 			if (c <= currentCapacity)
@@ -190,7 +248,7 @@ namespace vx
 #ifdef _VX_ARRAY_ANALYZER
 				++m_arrayStats.m_reserveLessCount;
 #endif
-				return;
+				return true;
 			}
 
 #ifdef _VX_ARRAY_ANALYZER
@@ -201,7 +259,9 @@ namespace vx
 #endif
 
 			auto oldSize = size();
-			auto newBlock = m_allocator.reallocate({ reinterpret_cast<u8*>(m_begin), m_blockSize }, sizeof(value_type) * c, __alignof(value_type));
+			auto newBlock = growBlock(c);
+			if (newBlock.ptr == nullptr)
+				return false;
 
 			m_begin = reinterpret_cast<pointer>(newBlock.ptr);
 			m_end = m_begin + oldSize;
@@ -212,15 +272,15 @@ namespace vx
 			++m_arrayStats.m_reserveCount;
 			m_arrayStats.updateMaxCapacity(static_cast<u32>(capacity()));
 #endif
+			return true;
 		}
 
-		void push_back(const value_type &value)
+		u32 push_back(const value_type &value)
 		{
 			if (m_end >= m_last)
 			{
-				auto cap = capacity();
-				cap = (cap == 0) ? 1 : cap * 2;
-				reserve(cap);
+				if (!grow(size() + 1))
+					return 0;
 			}
 
 			new (m_end++) value_type{ value };
@@ -228,16 +288,16 @@ namespace vx
 #ifdef _VX_ARRAY_ANALYZER
 			m_arrayStats.updateMaxSize(static_cast<u32>(size()));
 #endif
+			return 1;
 		}
 
 		template<typename ...Args>
-		void push_back(Args&& ...args)
+		u32 push_back(Args&& ...args)
 		{
 			if (m_end >= m_last)
 			{
-				auto cap = capacity();
-				cap = (cap == 0) ? 1 : cap * 2;
-				reserve(cap);
+				if (!grow(size() + 1))
+					return 0;
 			}
 
 			new (m_end++) value_type{ std::forward<Args>(args)... };
@@ -245,9 +305,10 @@ namespace vx
 #ifdef _VX_ARRAY_ANALYZER
 			m_arrayStats.updateMaxSize(static_cast<u32>(size()));
 #endif
+			return 1;
 		}
 
-		void push_back_range(const_iterator first, const_iterator last)
+		u32 push_back_range(const_iterator first, const_iterator last)
 		{
 			auto cap = capacity();
 			auto sz = size();
@@ -255,7 +316,8 @@ namespace vx
 			auto newSize = static_cast<u32>(sz + count);
 			if (newSize >= cap)
 			{
-				reserve(newSize);
+				if (!reserve(newSize))
+					return 0;
 			}
 
 			auto current = first;
@@ -267,18 +329,19 @@ namespace vx
 #ifdef _VX_ARRAY_ANALYZER
 			m_arrayStats.updateMaxSize(static_cast<u32>(size()));
 #endif
+			return 1;
 		}
 
-		void push_back_range(const DynamicArray &other)
+		u32 push_back_range(const DynamicArray &other)
 		{
 			auto first = other.begin();
 			auto last = other.end();
 
-			push_back_range(first, last);
+			return push_back_range(first, last);
 		}
 
 		template<typename U, typename Cvt>
-		void push_back_range(const DynamicArray<U> &other, Cvt cvt)
+		u32 push_back_range(const DynamicArray<U> &other, Cvt cvt)
 		{
 			auto first = other.begin();
 			auto last = other.end();
@@ -289,7 +352,8 @@ namespace vx
 			auto newSize = static_cast<u32>(sz + count);
 			if (newSize >= cap)
 			{
-				reserve(newSize);
+				if (!reserve(newSize))
+					return 0;
 			}
 
 			while (first != last)
@@ -300,6 +364,7 @@ namespace vx
 #ifdef _VX_ARRAY_ANALYZER
 			m_arrayStats.updateMaxSize(static_cast<u32>(size()));
 #endif
+			return 1;
 		}
 
 #ifdef _VX_ARRAY_ANALYZER
@@ -311,8 +376,8 @@ namespace vx
 
 	namespace detail
 	{
-		template<typename T, typename Allocator>
-		struct GetTypeInfo<vx::DynamicArray<T, Allocator>>
+		template<typename T, typename Allocator, typename GrowthPolicy>
+		struct GetTypeInfo<vx::DynamicArray<T, Allocator, GrowthPolicy>>
 		{
 			static const auto& get()
 			{
@@ -328,8 +393,8 @@ namespace vx
 				return getTypeInfo(concat("vx::DynamicArray<",
 					GetTypeInfo<T>::get_constexpr().m_name, ", ",
 					GetTypeInfo<Allocator>::get_constexpr().m_name, ">"), 
-					sizeof(vx::DynamicArray<T, Allocator>),
-					__alignof(vx::DynamicArray<T, Allocator>));
+					sizeof(vx::DynamicArray<T, Allocator, GrowthPolicy>),
+					__alignof(vx::DynamicArray<T, Allocator, GrowthPolicy>));
 			}
 		};
 	}
@@ -0,0 +1,307 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Allocator.h>
+#include <vxLib/util/bitops.h>
+#ifndef _VX_PLATFORM_ANDROID
+#include <xmmintrin.h>
+#endif
+#include <new>
+#include <utility>
+
+namespace vx
+{
+	/*
+	Eytzinger (breadth first) layout of a sorted array: element k has its children at 2k and 2k + 1, the root is at 1
+	and index 0 is unused. The first levels of every search share a few cache lines and the descendants of a node
+	log2(64 / sizeof(T)) levels down fill one contiguous cache line (4 levels for u32, 3 for u64), so they can be
+	prefetched while the current level is compared.
+	*/
+	namespace detail
+	{
+		template<typename T>
+		struct EytzingerPrefetch
+		{
+			// elements per cache line, k * Stride is the first descendant of k log2(Stride) levels down
+			enum : size_t { Stride = (sizeof(T) >= 64) ? 1 : (64 / sizeof(T)) };
+		};
+
+		inline void eytzingerPrefetch(const void* p)
+		{
+#ifndef _VX_PLATFORM_ANDROID
+			_mm_prefetch((const char*)p, _MM_HINT_T0);
+#else
+			__builtin_prefetch(p);
+#endif
+		}
+
+		// number of levels a search of count elements descends
+		inline u32 getEytzingerLevels(size_t count)
+		{
+			return (count == 0) ? 0 : (64 - nlz64((u64)count));
+		}
+
+		// in order traversal of the implicit tree, assign(k, i) places the i-th sorted element at node k. Returns the next i
+		template<typename F>
+		size_t eytzingerBuild(size_t count, size_t i, size_t k, F &&assign)
+		{
+			if (k <= count)
+			{
+				i = eytzingerBuild(count, i, 2 * k, assign);
+				assign(k, i++);
+				i = eytzingerBuild(count, i, 2 * k + 1, assign);
+			}
+
+			return i;
+		}
+
+		// number of nodes in the subtree rooted at k of a tree with count nodes
+		inline size_t eytzingerSubtreeSize(size_t k, size_t count)
+		{
+			size_t size = 0;
+			for (size_t first = k, width = 1; first <= count; first *= 2, width *= 2)
+			{
+				auto last = first + width - 1;
+				size += ((last < count) ? last : count) - first + 1;
+			}
+
+			return size;
+		}
+
+		// sorted position of node k, the inverse of the mapping eytzingerBuild assigns
+		inline size_t eytzingerRank(size_t k, size_t count)
+		{
+			auto rank = eytzingerSubtreeSize(2 * k, count);
+			for (; k > 1; k /= 2)
+			{
+				// a right child comes after its parent and the parent's left subtree
+				if (k & 1)
+					rank += eytzingerSubtreeSize(k - 1, count) + 1;
+			}
+
+			return rank;
+		}
+
+		// undoes the right turns taken after the last left turn, k is the node past the leaf
+		inline size_t eytzingerRetreat(size_t k)
+		{
+			return k >> (ntz64(~(u64)k) + 1);
+		}
+	}
+
+	// dst needs count + 1 elements, dst[0] is left untouched
+	template<typename T>
+	void eytzinger_build(const T* sorted, size_t count, T* dst)
+	{
+		detail::eytzingerBuild(count, 0, 1, [&](size_t k, size_t i) { dst[k] = sorted[i]; });
+	}
+
+	// returns the eytzinger index of the first element not less than key, 0 if there is none
+	template<typename T, typename K, typename Cmp>
+	size_t eytzinger_lower_bound(const T* e, size_t count, const K &key, Cmp cmp)
+	{
+		typedef detail::EytzingerPrefetch<T> Prefetch;
+
+		size_t k = 1;
+		while (k <= count)
+		{
+			detail::eytzingerPrefetch(e + k * Prefetch::Stride);
+			k = 2 * k + (size_t)cmp(e[k], key);
+		}
+
+		return detail::eytzingerRetreat(k);
+	}
+
+	/*
+	searches count keys interleaved, every key descends the same number of levels without branches so the loads of
+	independent searches overlap instead of waiting on each other. result[i] is the eytzinger index or 0.
+	*/
+	template<typename T, typename K, typename Cmp>
+	void eytzinger_lower_bound_batch(const T* e, size_t size, const K* keys, size_t count, size_t* result, Cmp cmp)
+	{
+		enum : size_t { BatchSize = 8 };
+
+		typedef detail::EytzingerPrefetch<T> Prefetch;
+
+		auto levels = detail::getEytzingerLevels(size);
+		for (size_t first = 0; first < count; first += BatchSize)
+		{
+			auto batch = (count - first < BatchSize) ? count - first : (size_t)BatchSize;
+
+			size_t k[BatchSize];
+			for (size_t j = 0; j < batch; ++j)
+			{
+				k[j] = 1;
+			}
+
+			for (u32 level = 0; level < levels; ++level)
+			{
+				for (size_t j = 0; j < batch; ++j)
+				{
+					// past the end the search keeps turning right, retreat removes those turns again
+					auto inside = (k[j] <= size);
+					auto index = inside ? k[j] : 1;
+					detail::eytzingerPrefetch(e + index * Prefetch::Stride);
+					k[j] = 2 * k[j] + (size_t)(!inside | cmp(e[index], keys[first + j]));
+				}
+			}
+
+			for (size_t j = 0; j < batch; ++j)
+			{
+				result[first + j] = detail::eytzingerRetreat(k[j]);
+			}
+		}
+	}
+
+	/*
+	read only search index over sorted keys, built once after bulk loading. Keeps an eytzinger ordered copy of the keys
+	and the sorted position of every node. The owner passes its allocator to build and release.
+	*/
+	template<typename K, typename Cmp>
+	class EytzingerIndex
+	{
+		typedef detail::EytzingerPrefetch<K> Prefetch;
+
+		enum : size_t { Alignment = 64 };
+
+		K* m_keys;
+		u32* m_positions;
+		size_t m_size;
+		size_t m_capacity;
+		AllocatedBlock m_keyBlock;
+		AllocatedBlock m_positionBlock;
+
+	public:
+		EytzingerIndex() :m_keys(nullptr), m_positions(nullptr), m_size(0), m_capacity(0), m_keyBlock(), m_positionBlock() {}
+
+		EytzingerIndex(const EytzingerIndex&) = delete;
+		EytzingerIndex& operator=(const EytzingerIndex&) = delete;
+
+		~EytzingerIndex() {}
+
+		void swap(EytzingerIndex &other)
+		{
+			std::swap(m_keys, other.m_keys);
+			std::swap(m_positions, other.m_positions);
+			std::swap(m_size, other.m_size);
+			std::swap(m_capacity, other.m_capacity);
+			std::swap(m_keyBlock, other.m_keyBlock);
+			std::swap(m_positionBlock, other.m_positionBlock);
+		}
+
+		template<typename Allocator>
+		bool build(const K* sortedKeys, size_t count, Allocator* allocator)
+		{
+			invalidate();
+			if (count == 0)
+				return true;
+
+			if (count > m_capacity)
+			{
+				release(allocator);
+
+				m_keyBlock = allocator->allocate(sizeof(K) * (count + 1), Alignment);
+				m_positionBlock = allocator->allocate(sizeof(u32) * (count + 1), Alignment);
+				if (m_keyBlock.ptr == nullptr || m_positionBlock.ptr == nullptr)
+				{
+					release(allocator);
+					return false;
+				}
+
+				m_keys = (K*)m_keyBlock.ptr;
+				m_positions = (u32*)m_positionBlock.ptr;
+				m_capacity = count;
+			}
+
+			auto keys = m_keys;
+			auto positions = m_positions;
+			detail::eytzingerBuild(count, 0, 1, [&](size_t k, size_t i)
+			{
+				new (keys + k) K(sortedKeys[i]);
+				positions[k] = (u32)i;
+			});
+
+			m_size = count;
+			return true;
+		}
+
+		// keys stay allocated for the next build
+		void invalidate()
+		{
+			for (size_t k = 1; k <= m_size; ++k)
+			{
+				m_keys[k].~K();
+			}
+			m_size = 0;
+		}
+
+		template<typename Allocator>
+		void release(Allocator* allocator)
+		{
+			invalidate();
+
+			if (m_keyBlock.ptr)
+				allocator->deallocate(m_keyBlock);
+			if (m_positionBlock.ptr)
+				allocator->deallocate(m_positionBlock);
+
+			m_keyBlock = { nullptr, 0 };
+			m_positionBlock = { nullptr, 0 };
+			m_keys = nullptr;
+			m_positions = nullptr;
+			m_capacity = 0;
+		}
+
+		// sorted position of the first key not less than key, size() if there is none
+		size_t lower_bound(const K &key) const
+		{
+			auto k = eytzinger_lower_bound(m_keys, m_size, key, Cmp());
+			return (k == 0) ? m_size : m_positions[k];
+		}
+
+		// sorted position of key, size() if it is missing
+		size_t find(const K &key) const
+		{
+			auto k = eytzinger_lower_bound(m_keys, m_size, key, Cmp());
+			return (k == 0 || Cmp()(key, m_keys[k])) ? m_size : m_positions[k];
+		}
+
+		// positions[i] is the sorted position of keys[i] or size()
+		void find_batch(const K* keys, size_t count, size_t* positions) const
+		{
+			eytzinger_lower_bound_batch(m_keys, m_size, keys, count, positions, Cmp());
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto k = positions[i];
+				positions[i] = (k == 0 || Cmp()(keys[i], m_keys[k])) ? m_size : m_positions[k];
+			}
+		}
+
+		size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+	};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/types.h>
+
+namespace vx
+{
+	/*
+	growth policies for DynamicArray, getCapacity returns the new capacity in elements for a full array
+	of capacity elements that needs room for at least required elements.
+	*/
+	struct GrowthPolicyDouble
+	{
+		static size_t getCapacity(size_t capacity, size_t required, size_t)
+		{
+			auto newCapacity = (capacity == 0) ? 1 : capacity * 2;
+			return (newCapacity < required) ? required : newCapacity;
+		}
+	};
+
+	// wastes less memory than doubling and lets freed blocks be reused by later growth steps
+	struct GrowthPolicyFactor15
+	{
+		static size_t getCapacity(size_t capacity, size_t required, size_t)
+		{
+			auto newCapacity = (capacity < 2) ? 2 : capacity + capacity / 2;
+			return (newCapacity < required) ? required : newCapacity;
+		}
+	};
+
+	// doubles, but rounds the block up to whole pages, for large arrays backed by page or virtual memory allocators
+	template<size_t PAGE_SIZE = 4 KBYTE>
+	struct GrowthPolicyPage
+	{
+		static_assert((PAGE_SIZE & (PAGE_SIZE - 1)) == 0, "");
+
+		static size_t getCapacity(size_t capacity, size_t required, size_t elementSize)
+		{
+			auto newCapacity = GrowthPolicyDouble::getCapacity(capacity, required, elementSize);
+			auto bytes = (newCapacity * elementSize + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+			return bytes / elementSize;
+		}
+	};
+
+	// grows by STEP elements, for arrays that grow slowly inside a linear or stack allocator
+	template<size_t STEP>
+	struct GrowthPolicyStep
+	{
+		static_assert(STEP != 0, "");
+
+		static size_t getCapacity(size_t capacity, size_t required, size_t)
+		{
+			auto newCapacity = capacity + STEP;
+			return (newCapacity < required) ? required : newCapacity;
+		}
+	};
+}
@@ -0,0 +1,524 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Mallocator.h>
+#include <vxLib/StringID.h>
+#include <vxLib/type_traits.h>
+#include <vxLib/util/bitops.h>
+#ifndef _VX_PLATFORM_ANDROID
+#include <emmintrin.h>
+#endif
+#include <cstring>
+#include <functional>
+#include <new>
+#include <utility>
+
+namespace vx
+{
+	// std::hash is the identity for integers, the finalizer spreads the bits into h1 and h2
+	template<typename K>
+	struct HashMapHash
+	{
+		u64 operator()(const K &key) const
+		{
+			u64 h = (u64)std::hash<K>()(key);
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53ull;
+			h ^= h >> 33;
+			return h;
+		}
+	};
+
+	// string ids already are a CityHash64
+	template<>
+	struct HashMapHash<StringID>
+	{
+		u64 operator()(const StringID &key) const
+		{
+			return key.value;
+		}
+	};
+
+	namespace detail
+	{
+		// 16 control bytes probed with sse2, bit i of a mask is set for a match at control byte i
+		struct HashMapGroup
+		{
+			enum : u32 { Width = 16 };
+
+			enum : s8
+			{
+				Empty = -128,
+				Deleted = -2
+			};
+
+#ifndef _VX_PLATFORM_ANDROID
+			__m128i ctrl;
+
+			explicit HashMapGroup(const s8* p) :ctrl(_mm_loadu_si128((const __m128i*)p)) {}
+
+			u32 match(s8 h2) const
+			{
+				return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+			}
+
+			u32 matchEmpty() const
+			{
+				return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(Empty), ctrl));
+			}
+
+			// empty and deleted both have the sign bit set
+			u32 matchEmptyOrDeleted() const
+			{
+				return (u32)_mm_movemask_epi8(ctrl);
+			}
+#else
+			s8 ctrl[Width];
+
+			explicit HashMapGroup(const s8* p) { ::memcpy(ctrl, p, Width); }
+
+			u32 match(s8 h2) const
+			{
+				u32 mask = 0;
+				for (u32 i = 0; i < Width; ++i)
+				{
+					mask |= (u32)(ctrl[i] == h2) << i;
+				}
+				return mask;
+			}
+
+			u32 matchEmpty() const
+			{
+				return match(Empty);
+			}
+
+			u32 matchEmptyOrDeleted() const
+			{
+				u32 mask = 0;
+				for (u32 i = 0; i < Width; ++i)
+				{
+					mask |= (u32)(ctrl[i] < 0) << i;
+				}
+				return mask;
+			}
+#endif
+		};
+	}
+
+	/*
+	open addressing hash map with SwissTable style control bytes. Every slot has a control byte holding the low 7 bits
+	of the hash (h2) or empty/deleted, probing tests 16 control bytes at once and only compares keys on h2 matches.
+	Slots and control bytes share one allocation that grows through Allocator::reallocate and is rehashed in place,
+	so K and V need to be trivially relocatable (vx::is_trivially_relocatable), this is checked at compile time.
+	Functions taking a hash skip the hasher, e.g. for hashes stored next to resource names.
+	*/
+	template<typename K, typename V, typename Allocator = Mallocator, typename Hasher = HashMapHash<K>>
+	class HashMap
+	{
+		typedef detail::HashMapGroup Group;
+
+		struct Slot
+		{
+			K key;
+			V value;
+		};
+
+		static_assert(vx::is_trivially_relocatable<K>::value && vx::is_trivially_relocatable<V>::value, "slots are moved by reallocate and need to be trivially relocatable");
+		static_assert(sizeof(Slot) >= 2, "control bytes of the old table need to fit into the grown slot array");
+
+		enum : size_t
+		{
+			MinCapacity = Group::Width,
+			SlotAlignment = (__alignof(Slot) < 16) ? 16 : __alignof(Slot)
+		};
+
+		Slot* m_slots;
+		s8* m_ctrl;
+		size_t m_size;
+		size_t m_capacity;
+		size_t m_growthLeft;
+		AllocatedBlock m_block;
+		Allocator m_allocator;
+		Hasher m_hasher;
+
+		static size_t getMaxLoad(size_t capacity) { return capacity - capacity / 8; }
+		static size_t getBlockSize(size_t capacity) { return sizeof(Slot) * capacity + capacity + Group::Width; }
+
+		static size_t getH1(u64 hash) { return (size_t)(hash >> 7); }
+		static s8 getH2(u64 hash) { return (s8)(hash & 0x7f); }
+
+		static bool isFull(s8 ctrl) { return ctrl >= 0; }
+
+		void setCtrl(size_t index, s8 value)
+		{
+			m_ctrl[index] = value;
+			// the first group is mirrored behind the table so unaligned group loads never wrap
+			if (index < Group::Width)
+				m_ctrl[m_capacity + index] = value;
+		}
+
+		// first empty or deleted slot on the probe sequence of hash
+		size_t findFreeSlot(u64 hash) const
+		{
+			auto mask = m_capacity - 1;
+			auto pos = getH1(hash) & mask;
+			size_t step = 0;
+			for (;;)
+			{
+				Group group(m_ctrl + pos);
+				auto free = group.matchEmptyOrDeleted();
+				if (free != 0)
+					return (pos + ntz64(free)) & mask;
+
+				step += Group::Width;
+				pos = (pos + step) & mask;
+			}
+		}
+
+		Slot* findSlot(const K &key, u64 hash) const
+		{
+			if (m_capacity == 0)
+				return nullptr;
+
+			auto mask = m_capacity - 1;
+			auto h2 = getH2(hash);
+			auto pos = getH1(hash) & mask;
+			size_t step = 0;
+			for (;;)
+			{
+				Group group(m_ctrl + pos);
+				auto matches = group.match(h2);
+				while (matches != 0)
+				{
+					auto index = (pos + ntz64(matches)) & mask;
+					if (m_slots[index].key == key)
+						return &m_slots[index];
+
+					matches &= matches - 1;
+				}
+
+				if (group.matchEmpty() != 0)
+					return nullptr;
+
+				step += Group::Width;
+				pos = (pos + step) & mask;
+			}
+		}
+
+		void resetCtrl()
+		{
+			::memset(m_ctrl, (u8)Group::Empty, m_capacity + Group::Width);
+			m_growthLeft = getMaxLoad(m_capacity) - m_size;
+		}
+
+		/*
+		every full slot has been marked deleted, moves each one to its probe group for the current capacity.
+		A slot that is already in the first group it would probe stays, others move to an empty slot
+		or swap with a deleted one that is processed again.
+		*/
+		void rehashInPlace()
+		{
+			auto mask = m_capacity - 1;
+			for (size_t i = 0; i < m_capacity; ++i)
+			{
+				if (m_ctrl[i] != Group::Deleted)
+					continue;
+
+				auto hash = m_hasher(m_slots[i].key);
+				auto h2 = getH2(hash);
+				auto probeStart = getH1(hash) & mask;
+				auto target = findFreeSlot(hash);
+
+				if ((((i - probeStart) & mask) / Group::Width) == (((target - probeStart) & mask) / Group::Width))
+				{
+					setCtrl(i, h2);
+					continue;
+				}
+
+				if (m_ctrl[target] == Group::Empty)
+				{
+					new (&m_slots[target]) Slot(std::move(m_slots[i]));
+					m_slots[i].~Slot();
+					setCtrl(target, h2);
+					setCtrl(i, Group::Empty);
+				}
+				else
+				{
+					setCtrl(target, h2);
+					std::swap(m_slots[i], m_slots[target]);
+					--i;
+				}
+			}
+
+			m_growthLeft = getMaxLoad(m_capacity) - m_size;
+		}
+
+		bool rehash(size_t capacity)
+		{
+			auto oldCapacity = m_capacity;
+			auto newBlock = m_allocator.reallocate(m_block, getBlockSize(capacity), SlotAlignment);
+			if (newBlock.ptr == nullptr)
+				return false;
+
+			// the old control bytes were copied behind the old slots, which is inside the new slot array
+			auto slots = (Slot*)newBlock.ptr;
+			auto ctrl = (s8*)(slots + capacity);
+			auto oldCtrl = (const s8*)(slots + oldCapacity);
+			for (size_t i = 0; i < oldCapacity; ++i)
+			{
+				ctrl[i] = isFull(oldCtrl[i]) ? (s8)Group::Deleted : (s8)Group::Empty;
+			}
+
+			m_block = newBlock;
+			m_slots = slots;
+			m_ctrl = ctrl;
+			m_capacity = capacity;
+
+			::memset(m_ctrl + oldCapacity, (u8)Group::Empty, capacity - oldCapacity);
+			::memcpy(m_ctrl + capacity, m_ctrl, Group::Width);
+
+			rehashInPlace();
+			return true;
+		}
+
+		bool growIfFull()
+		{
+			if (m_growthLeft != 0)
+				return true;
+
+			if (m_capacity == 0)
+				return reserve(1);
+
+			// mostly tombstones, cleaning up is enough
+			if (m_size <= getMaxLoad(m_capacity) / 2)
+			{
+				for (size_t i = 0; i < m_capacity; ++i)
+				{
+					m_ctrl[i] = isFull(m_ctrl[i]) ? (s8)Group::Deleted : (s8)Group::Empty;
+				}
+				::memcpy(m_ctrl + m_capacity, m_ctrl, Group::Width);
+
+				rehashInPlace();
+				return true;
+			}
+
+			return rehash(m_capacity * 2);
+		}
+
+	public:
+		HashMap() :m_slots(nullptr), m_ctrl(nullptr), m_size(0), m_capacity(0), m_growthLeft(0), m_block(), m_allocator(), m_hasher() {}
+
+		explicit HashMap(Allocator &&allocator) :HashMap() { m_allocator = std::move(allocator); }
+
+		HashMap(Allocator &&allocator, size_t count) :HashMap(std::move(allocator)) { reserve(count); }
+
+		HashMap(const HashMap&) = delete;
+		HashMap& operator=(const HashMap&) = delete;
+
+		HashMap(HashMap &&rhs) :HashMap()
+		{
+			swap(rhs);
+		}
+
+		HashMap& operator=(HashMap &&rhs)
+		{
+			if (this != &rhs)
+			{
+				swap(rhs);
+			}
+			return *this;
+		}
+
+		~HashMap()
+		{
+			release();
+		}
+
+		void swap(HashMap &other)
+		{
+			std::swap(m_slots, other.m_slots);
+			std::swap(m_ctrl, other.m_ctrl);
+			std::swap(m_size, other.m_size);
+			std::swap(m_capacity, other.m_capacity);
+			std::swap(m_growthLeft, other.m_growthLeft);
+			std::swap(m_block, other.m_block);
+			m_allocator.swap(other.m_allocator);
+			std::swap(m_hasher, other.m_hasher);
+		}
+
+		// makes room for count elements without growing
+		bool reserve(size_t count)
+		{
+			auto capacity = (m_capacity == 0) ? (size_t)MinCapacity : m_capacity;
+			while (getMaxLoad(capacity) < count)
+			{
+				capacity *= 2;
+			}
+
+			if (capacity == m_capacity)
+				return true;
+
+			if (m_capacity == 0)
+			{
+				auto block = m_allocator.allocate(getBlockSize(capacity), SlotAlignment);
+				if (block.ptr == nullptr)
+					return false;
+
+				m_block = block;
+				m_slots = (Slot*)block.ptr;
+				m_ctrl = (s8*)(m_slots + capacity);
+				m_capacity = capacity;
+				resetCtrl();
+				return true;
+			}
+
+			return rehash(capacity);
+		}
+
+		// returns the existing value if key is already present, nullptr if the table could not grow
+		template<typename ...Args>
+		V* insertHashed(const K &key, u64 hash, Args&& ...args)
+		{
+			auto slot = findSlot(key, hash);
+			if (slot)
+				return &slot->value;
+
+			if (!growIfFull())
+				return nullptr;
+
+			auto index = findFreeSlot(hash);
+			if (m_ctrl[index] == Group::Empty)
+				--m_growthLeft;
+
+			slot = &m_slots[index];
+			new (&slot->key) K(key);
+			new (&slot->value) V(std::forward<Args>(args)...);
+			setCtrl(index, getH2(hash));
+			++m_size;
+
+			return &slot->value;
+		}
+
+		template<typename ...Args>
+		V* insert(const K &key, Args&& ...args)
+		{
+			return insertHashed(key, m_hasher(key), std::forward<Args>(args)...);
+		}
+
+		V* findHashed(const K &key, u64 hash)
+		{
+			auto slot = findSlot(key, hash);
+			return slot ? &slot->value : nullptr;
+		}
+
+		const V* findHashed(const K &key, u64 hash) const
+		{
+			auto slot = findSlot(key, hash);
+			return slot ? &slot->value : nullptr;
+		}
+
+		V* find(const K &key) { return findHashed(key, m_hasher(key)); }
+		const V* find(const K &key) const { return findHashed(key, m_hasher(key)); }
+
+		bool contains(const K &key) const { return find(key) != nullptr; }
+
+		bool eraseHashed(const K &key, u64 hash)
+		{
+			auto slot = findSlot(key, hash);
+			if (slot == nullptr)
+				return false;
+
+			auto index = (size_t)(slot - m_slots);
+			auto mask = m_capacity - 1;
+			slot->~Slot();
+			--m_size;
+
+			// a probe can only have passed this slot if no empty slot surrounds it within one group
+			auto emptyBefore = Group(m_ctrl + ((index - Group::Width) & mask)).matchEmpty();
+			auto emptyAfter = Group(m_ctrl + index).matchEmpty();
+			auto wasNeverFull = (emptyBefore != 0) && (emptyAfter != 0) && ((nlz64(emptyBefore) - 48) + ntz64(emptyAfter) < Group::Width);
+
+			if (wasNeverFull)
+			{
+				setCtrl(index, Group::Empty);
+				++m_growthLeft;
+			}
+			else
+			{
+				setCtrl(index, Group::Deleted);
+			}
+
+			return true;
+		}
+
+		bool erase(const K &key) { return eraseHashed(key, m_hasher(key)); }
+
+		// f(const K&, V&)
+		template<typename F>
+		void forEach(F &&f)
+		{
+			for (size_t i = 0; i < m_capacity; ++i)
+			{
+				if (isFull(m_ctrl[i]))
+					f((const K&)m_slots[i].key, m_slots[i].value);
+			}
+		}
+
+		void clear()
+		{
+			for (size_t i = 0; i < m_capacity; ++i)
+			{
+				if (isFull(m_ctrl[i]))
+					m_slots[i].~Slot();
+			}
+
+			m_size = 0;
+			if (m_capacity != 0)
+				resetCtrl();
+		}
+
+		void release()
+		{
+			if (m_block.ptr)
+			{
+				clear();
+				m_allocator.deallocate(m_block);
+			}
+
+			m_block = { nullptr, 0 };
+			m_slots = nullptr;
+			m_ctrl = nullptr;
+			m_capacity = 0;
+			m_growthLeft = 0;
+		}
+
+		size_t size() const { return m_size; }
+		size_t capacity() const { return m_capacity; }
+		bool empty() const { return m_size == 0; }
+	};
+}
@@ -37,6 +37,10 @@ namespace vx
 		typedef Allocator MyAllocator;
 		typedef ArrayBase<T> MyBase;
 
+		using MyBase::m_begin;
+		using MyBase::m_end;
+		using MyBase::m_last;
+
 		enum {BUFFER_SIZE = sizeof(T) * COUNT };
 
 		u8 m_data[BUFFER_SIZE];
@@ -58,6 +62,12 @@ namespace vx
 		typedef typename MyBase::iterator iterator;
 		typedef typename MyBase::const_iterator const_iterator;
 
+		using MyBase::begin;
+		using MyBase::end;
+		using MyBase::size;
+		using MyBase::capacity;
+		using MyBase::clear;
+
 		InplaceArray()
 			:MyBase(reinterpret_cast<pointer>(m_data), reinterpret_cast<pointer>(m_data + BUFFER_SIZE)), 
 			m_data(), 
@@ -266,12 +276,12 @@ namespace vx
 
 			reserve(sz);
 
-			auto d = sz - currentSize;
-			while (d)
-			{
-				push_back(value_type{});
-				--d;
-			}
+			vx::uninitialized_default_n(m_end, sz - currentSize);
+			m_end = m_begin + sz;
+
+#ifdef _VX_ARRAY_ANALYZER
+			m_arrayStats.updateMaxSize(static_cast<u32>(size()));
+#endif
 		}
 
 		void reserve(size_t c)
@@ -298,7 +308,7 @@ namespace vx
 			auto newBlock = m_allocator.reallocate({ blockPtr, m_blockSize }, sizeof(value_type) * c, __alignof(value_type));
 			if (blockPtr == nullptr)
 			{
-				::memcpy(newBlock.ptr, m_data, sizeof(value_type) * size_);
+				vx::relocate_n(reinterpret_cast<pointer>(m_data), size_, reinterpret_cast<pointer>(newBlock.ptr));
 				::memset(m_data, 0xd, BUFFER_SIZE);
 			}
 
@@ -392,8 +402,6 @@ namespace vx
 				new (m_end++) value_type{ cvt(*(first++)) };
 			}
 
-			m_size = newSize;
-
 #ifdef _VX_ARRAY_ANALYZER
 			m_arrayStats.updateMaxSize(size());
 #endif
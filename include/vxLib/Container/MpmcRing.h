@@ -0,0 +1,242 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Mallocator.h>
+#include <vxLib/algorithm.h>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace vx
+{
+	/*
+	bounded lock-free queue for any number of producers and consumers (Dmitry Vyukov's bounded MPMC queue).
+	Every cell carries a sequence number that tells whether it is free for the position a producer claims or
+	holds the value for the position a consumer claims, positions are claimed with a CAS on the head or tail counter.
+	push_n/pop_n claim the whole ready prefix with a single CAS. The capacity is rounded up to a power of two, at least 2.
+	initialize and release are not thread safe.
+	*/
+	template<typename T, typename Allocator = Mallocator>
+	class MpmcRing
+	{
+		struct Cell
+		{
+			std::atomic<size_t> sequence;
+			typename std::aligned_storage<sizeof(T), __alignof(T)>::type storage;
+
+			T* get() { return reinterpret_cast<T*>(&storage); }
+		};
+
+		struct VX_ALIGN(64) Counter
+		{
+			std::atomic<size_t> value;
+		};
+
+		Counter m_tail;
+		Counter m_head;
+		Cell* m_cells;
+		size_t m_mask;
+		Allocator m_allocator;
+
+		enum : size_t { CellAlignment = (__alignof(Cell) < 64) ? 64 : __alignof(Cell) };
+
+		// number of cells starting at pos, up to count, whose sequence equals pos + i + offset
+		size_t getReadyCount(size_t pos, size_t count, size_t offset) const
+		{
+			size_t ready = 0;
+			while (ready < count)
+			{
+				auto &cell = m_cells[(pos + ready) & m_mask];
+				if (cell.sequence.load(std::memory_order_acquire) != pos + ready + offset)
+					break;
+
+				++ready;
+			}
+			return ready;
+		}
+
+		// claims up to count consecutive ready positions from counter, returns the first position
+		size_t claim(Counter* counter, size_t* count, size_t offset)
+		{
+			auto pos = counter->value.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				auto ready = getReadyCount(pos, *count, offset);
+				if (ready == 0)
+				{
+					// the first cell is not ready, either the ring is full/empty or pos is stale
+					auto current = counter->value.load(std::memory_order_relaxed);
+					if (current == pos)
+					{
+						*count = 0;
+						return pos;
+					}
+
+					pos = current;
+					continue;
+				}
+
+				if (counter->value.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed))
+				{
+					*count = ready;
+					return pos;
+				}
+			}
+		}
+
+	public:
+		MpmcRing() :m_cells(nullptr), m_mask(0), m_allocator()
+		{
+			m_tail.value.store(0, std::memory_order_relaxed);
+			m_head.value.store(0, std::memory_order_relaxed);
+		}
+
+		explicit MpmcRing(Allocator &&allocator) :MpmcRing() { m_allocator = std::move(allocator); }
+
+		MpmcRing(const MpmcRing&) = delete;
+		MpmcRing& operator=(const MpmcRing&) = delete;
+
+		~MpmcRing() { release(); }
+
+		bool initialize(size_t capacity)
+		{
+			VX_ASSERT(m_cells == nullptr && capacity != 0);
+
+			size_t size = 2;
+			while (size < capacity)
+				size <<= 1;
+
+			auto block = m_allocator.allocate(sizeof(Cell) * size, CellAlignment);
+			if (block.ptr == nullptr)
+				return false;
+
+			m_cells = (Cell*)block.ptr;
+			for (size_t i = 0; i < size; ++i)
+			{
+				new (&m_cells[i].sequence) std::atomic<size_t>(i);
+			}
+
+			m_mask = size - 1;
+			m_tail.value.store(0, std::memory_order_relaxed);
+			m_head.value.store(0, std::memory_order_relaxed);
+			return true;
+		}
+
+		// destroys queued elements and returns the storage
+		void release()
+		{
+			if (m_cells == nullptr)
+				return;
+
+			auto head = m_head.value.load(std::memory_order_relaxed);
+			auto tail = m_tail.value.load(std::memory_order_relaxed);
+			for (; head != tail; ++head)
+			{
+				vx::destruct(m_cells[head & m_mask].get());
+			}
+
+			m_allocator.deallocate({ (u8*)m_cells, sizeof(Cell) * (m_mask + 1) });
+			m_cells = nullptr;
+			m_mask = 0;
+		}
+
+		template<typename ...Args>
+		bool emplace(Args&& ...args)
+		{
+			size_t count = 1;
+			auto pos = claim(&m_tail, &count, 0);
+			if (count == 0)
+				return false;
+
+			auto &cell = m_cells[pos & m_mask];
+			new (cell.get()) T(std::forward<Args>(args)...);
+			cell.sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool push(const T &value) { return emplace(value); }
+		bool push(T &&value) { return emplace(std::move(value)); }
+
+		// copies up to count values into consecutive free cells, returns the number pushed
+		size_t push_n(const T* values, size_t count)
+		{
+			if (count == 0)
+				return 0;
+
+			auto pos = claim(&m_tail, &count, 0);
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto &cell = m_cells[(pos + i) & m_mask];
+				new (cell.get()) T(values[i]);
+				cell.sequence.store(pos + i + 1, std::memory_order_release);
+			}
+			return count;
+		}
+
+		bool pop(T* value)
+		{
+			size_t count = 1;
+			auto pos = claim(&m_head, &count, 1);
+			if (count == 0)
+				return false;
+
+			auto &cell = m_cells[pos & m_mask];
+			*value = std::move(*cell.get());
+			vx::destruct(cell.get());
+			cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		// moves up to count values out of consecutive filled cells, returns the number popped
+		size_t pop_n(T* values, size_t count)
+		{
+			if (count == 0)
+				return 0;
+
+			auto pos = claim(&m_head, &count, 1);
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto &cell = m_cells[(pos + i) & m_mask];
+				values[i] = std::move(*cell.get());
+				vx::destruct(cell.get());
+				cell.sequence.store(pos + i + m_mask + 1, std::memory_order_release);
+			}
+			return count;
+		}
+
+		// only exact when no thread is pushing or popping
+		size_t size() const
+		{
+			auto tail = m_tail.value.load(std::memory_order_acquire);
+			auto head = m_head.value.load(std::memory_order_acquire);
+			return (tail > head) ? tail - head : 0;
+		}
+
+		bool empty() const { return size() == 0; }
+		size_t capacity() const { return (m_cells != nullptr) ? m_mask + 1 : 0; }
+	};
+}
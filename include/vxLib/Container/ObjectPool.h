@@ -0,0 +1,308 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Mallocator.h>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace vx
+{
+	// 20 bit slot index and 12 bit generation, a value of zero is never handed out
+	struct ObjectPoolHandle
+	{
+		enum : u32
+		{
+			IndexBits = 20,
+			GenerationBits = 32 - IndexBits,
+			IndexMask = (1u << IndexBits) - 1,
+			GenerationMask = (1u << GenerationBits) - 1,
+			MaxIndex = IndexMask
+		};
+
+		u32 value;
+
+		ObjectPoolHandle() :value(0) {}
+		ObjectPoolHandle(u32 index, u32 generation) :value((generation << IndexBits) | index) {}
+
+		u32 getIndex() const { return value & IndexMask; }
+		u32 getGeneration() const { return value >> IndexBits; }
+
+		bool isNull() const { return value == 0; }
+
+		bool operator==(const ObjectPoolHandle &rhs) const { return value == rhs.value; }
+		bool operator!=(const ObjectPoolHandle &rhs) const { return value != rhs.value; }
+	};
+
+	/*
+	pool of T with generational handles. Live objects are packed densely into chunks of ChunkSize objects,
+	a destroyed object is replaced by the last one, so forEachChunk walks plain contiguous arrays.
+	Chunks never move, so growing the pool does not touch existing objects.
+	*/
+	template<typename T, typename Allocator = Mallocator>
+	class ObjectPool
+	{
+	public:
+		typedef ObjectPoolHandle Handle;
+
+		enum : u32 { ChunkSize = 64 };
+
+	private:
+		enum : u32 { FreeListEnd = 0xffffffff };
+
+		struct Slot
+		{
+			// position in the dense storage while alive, next free slot otherwise
+			u32 denseIndex;
+			u32 generation;
+		};
+
+		T** m_chunks;
+		u32* m_denseToSlot;
+		Slot* m_slots;
+		u32 m_size;
+		u32 m_capacity;
+		u32 m_chunkCount;
+		u32 m_slotCount;
+		u32 m_freeSlot;
+		Allocator m_allocator;
+
+		T* getDense(u32 index) const
+		{
+			return m_chunks[index / ChunkSize] + (index % ChunkSize);
+		}
+
+		// copies the old array into block and frees it, block already has room for the new count
+		template<typename U>
+		void moveArray(U** ptr, size_t oldCount, const AllocatedBlock block)
+		{
+			if (*ptr != nullptr)
+			{
+				::memcpy(block.ptr, *ptr, sizeof(U) * oldCount);
+				m_allocator.deallocate({ (u8*)*ptr, sizeof(U) * oldCount });
+			}
+
+			*ptr = (U*)block.ptr;
+		}
+
+		bool grow()
+		{
+			if (m_capacity + ChunkSize > Handle::MaxIndex)
+				return false;
+
+			auto capacity = m_capacity + ChunkSize;
+
+			// all blocks are allocated before any array is replaced, so a failure leaves the pool as it was
+			auto chunk = m_allocator.allocate(sizeof(T) * ChunkSize, __alignof(T));
+			auto chunks = m_allocator.allocate(sizeof(T*) * (m_chunkCount + 1), __alignof(T*));
+			auto denseToSlot = m_allocator.allocate(sizeof(u32) * capacity, __alignof(u32));
+			auto slots = m_allocator.allocate(sizeof(Slot) * capacity, __alignof(Slot));
+			if (chunk.ptr == nullptr || chunks.ptr == nullptr || denseToSlot.ptr == nullptr || slots.ptr == nullptr)
+			{
+				m_allocator.deallocate(slots);
+				m_allocator.deallocate(denseToSlot);
+				m_allocator.deallocate(chunks);
+				m_allocator.deallocate(chunk);
+				return false;
+			}
+
+			moveArray(&m_chunks, m_chunkCount, chunks);
+			moveArray(&m_denseToSlot, m_capacity, denseToSlot);
+			moveArray(&m_slots, m_capacity, slots);
+
+			m_chunks[m_chunkCount++] = (T*)chunk.ptr;
+			m_capacity = capacity;
+			return true;
+		}
+
+		u32 acquireSlot()
+		{
+			if (m_freeSlot != FreeListEnd)
+			{
+				auto index = m_freeSlot;
+				m_freeSlot = m_slots[index].denseIndex;
+				return index;
+			}
+
+			auto index = m_slotCount++;
+			m_slots[index].generation = 1;
+			return index;
+		}
+
+	public:
+		ObjectPool() :m_chunks(nullptr), m_denseToSlot(nullptr), m_slots(nullptr), m_size(0), m_capacity(0), m_chunkCount(0), m_slotCount(0), m_freeSlot(FreeListEnd), m_allocator() {}
+
+		explicit ObjectPool(Allocator &&allocator) :ObjectPool() { m_allocator = std::move(allocator); }
+
+		ObjectPool(const ObjectPool&) = delete;
+		ObjectPool& operator=(const ObjectPool&) = delete;
+
+		~ObjectPool()
+		{
+			release();
+		}
+
+		template<typename ...Args>
+		Handle create(Args&& ...args)
+		{
+			if (m_size == m_capacity && !grow())
+				return Handle();
+
+			auto slotIndex = acquireSlot();
+			auto denseIndex = m_size++;
+
+			new (getDense(denseIndex)) T(std::forward<Args>(args)...);
+			m_denseToSlot[denseIndex] = slotIndex;
+			m_slots[slotIndex].denseIndex = denseIndex;
+
+			return Handle(slotIndex, m_slots[slotIndex].generation);
+		}
+
+		bool destroy(Handle handle)
+		{
+			if (!isValid(handle))
+				return false;
+
+			auto slotIndex = handle.getIndex();
+			auto &slot = m_slots[slotIndex];
+			auto denseIndex = slot.denseIndex;
+			auto lastIndex = --m_size;
+
+			auto object = getDense(denseIndex);
+			if (denseIndex != lastIndex)
+			{
+				auto last = getDense(lastIndex);
+				*object = std::move(*last);
+				object = last;
+
+				auto movedSlot = m_denseToSlot[lastIndex];
+				m_denseToSlot[denseIndex] = movedSlot;
+				m_slots[movedSlot].denseIndex = denseIndex;
+			}
+			object->~T();
+
+			// generation 0 is skipped so a zero handle never becomes valid
+			slot.generation = (slot.generation + 1) & Handle::GenerationMask;
+			if (slot.generation == 0)
+				slot.generation = 1;
+
+			slot.denseIndex = m_freeSlot;
+			m_freeSlot = slotIndex;
+
+			return true;
+		}
+
+		bool isValid(Handle handle) const
+		{
+			auto index = handle.getIndex();
+			if (handle.isNull() || index >= m_slotCount)
+				return false;
+
+			auto &slot = m_slots[index];
+			return slot.generation == handle.getGeneration() && slot.denseIndex < m_size && m_denseToSlot[slot.denseIndex] == index;
+		}
+
+		T* get(Handle handle)
+		{
+			return isValid(handle) ? getDense(m_slots[handle.getIndex()].denseIndex) : nullptr;
+		}
+
+		const T* get(Handle handle) const
+		{
+			return isValid(handle) ? getDense(m_slots[handle.getIndex()].denseIndex) : nullptr;
+		}
+
+		// dense access, indices change when objects are destroyed
+		T& operator[](u32 denseIndex) { return *getDense(denseIndex); }
+		const T& operator[](u32 denseIndex) const { return *getDense(denseIndex); }
+
+		Handle getHandle(u32 denseIndex) const
+		{
+			auto slotIndex = m_denseToSlot[denseIndex];
+			return Handle(slotIndex, m_slots[slotIndex].generation);
+		}
+
+		// f(T* objects, u32 count) is called once per chunk with live objects
+		template<typename F>
+		void forEachChunk(F &&f)
+		{
+			auto remaining = m_size;
+			for (u32 i = 0; remaining != 0; ++i)
+			{
+				auto count = (remaining < ChunkSize) ? remaining : (u32)ChunkSize;
+				f(m_chunks[i], count);
+				remaining -= count;
+			}
+		}
+
+		template<typename F>
+		void forEach(F &&f)
+		{
+			forEachChunk([&](T* objects, u32 count)
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					f(objects[i]);
+				}
+			});
+		}
+
+		void clear()
+		{
+			while (m_size != 0)
+			{
+				destroy(getHandle(m_size - 1));
+			}
+		}
+
+		void release()
+		{
+			clear();
+
+			for (u32 i = 0; i < m_chunkCount; ++i)
+			{
+				m_allocator.deallocate({ (u8*)m_chunks[i], sizeof(T) * ChunkSize });
+			}
+
+			if (m_chunks)
+			{
+				m_allocator.deallocate({ (u8*)m_chunks, sizeof(T*) * m_chunkCount });
+				m_allocator.deallocate({ (u8*)m_denseToSlot, sizeof(u32) * m_capacity });
+				m_allocator.deallocate({ (u8*)m_slots, sizeof(Slot) * m_capacity });
+			}
+
+			m_chunks = nullptr;
+			m_denseToSlot = nullptr;
+			m_slots = nullptr;
+			m_capacity = m_chunkCount = m_slotCount = 0;
+			m_freeSlot = FreeListEnd;
+		}
+
+		u32 size() const { return m_size; }
+		u32 capacity() const { return m_capacity; }
+		bool empty() const { return m_size == 0; }
+	};
+}
@@ -0,0 +1,319 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Mallocator.h>
+#include <vxLib/algorithm.h>
+#include <new>
+#include <utility>
+
+namespace vx
+{
+	/*
+	array of T stored in fixed size chunks of CHUNK elements. Elements never move, pointers stay valid until the
+	element is popped, and growing only allocates a new chunk, nothing is copied.
+	Chunks come from ChunkAllocator with a size of ChunkBytes, so a BitmapBlock or ChuckAllocator with that block
+	size can serve them. The chunk pointer table is small and grows through TableAllocator.
+	forEachChunk and getChunk hand out contiguous ranges, e.g. one chunk per worker.
+	*/
+	template<typename T, size_t CHUNK = 1024, typename ChunkAllocator = Mallocator, typename TableAllocator = Mallocator>
+	class SegmentedArray
+	{
+		static_assert(CHUNK != 0 && (CHUNK & (CHUNK - 1)) == 0, "CHUNK must be a power of two");
+
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+
+		enum : size_t
+		{
+			ChunkSize = CHUNK,
+			ChunkMask = CHUNK - 1,
+			ChunkBytes = sizeof(T) * CHUNK
+		};
+
+	private:
+		T** m_chunks;
+		size_t m_size;
+		size_t m_chunkCount;
+		size_t m_tableCapacity;
+		ChunkAllocator m_allocator;
+		TableAllocator m_tableAllocator;
+
+		static size_t getChunkIndex(size_t index) { return index / CHUNK; }
+
+		bool growTable()
+		{
+			auto capacity = (m_tableCapacity == 0) ? 8 : m_tableCapacity * 2;
+			auto block = m_tableAllocator.reallocate({ (u8*)m_chunks, sizeof(T*) * m_tableCapacity }, sizeof(T*) * capacity, __alignof(T*));
+			if (block.ptr == nullptr)
+				return false;
+
+			m_chunks = (T**)block.ptr;
+			m_tableCapacity = capacity;
+			return true;
+		}
+
+		bool addChunk()
+		{
+			if (m_chunkCount == m_tableCapacity && !growTable())
+				return false;
+
+			auto chunk = m_allocator.allocate(ChunkBytes, __alignof(T));
+			if (chunk.ptr == nullptr)
+				return false;
+
+			m_chunks[m_chunkCount++] = (T*)chunk.ptr;
+			return true;
+		}
+
+		void freeChunks(size_t keepCount)
+		{
+			while (m_chunkCount > keepCount)
+			{
+				m_allocator.deallocate({ (u8*)m_chunks[--m_chunkCount], ChunkBytes });
+			}
+		}
+
+		template<typename Array, typename Ptr>
+		class Iterator
+		{
+			Array* m_array;
+			size_t m_index;
+
+		public:
+			Iterator(Array* a, size_t index) :m_array(a), m_index(index) {}
+
+			auto& operator*() const { return (*m_array)[m_index]; }
+			Ptr operator->() const { return &(*m_array)[m_index]; }
+
+			Iterator& operator++() { ++m_index; return *this; }
+			Iterator operator++(int) { auto tmp = *this; ++m_index; return tmp; }
+
+			bool operator==(const Iterator &rhs) const { return m_index == rhs.m_index; }
+			bool operator!=(const Iterator &rhs) const { return m_index != rhs.m_index; }
+		};
+
+	public:
+		typedef Iterator<SegmentedArray, pointer> iterator;
+		typedef Iterator<const SegmentedArray, const_pointer> const_iterator;
+
+		SegmentedArray() :m_chunks(nullptr), m_size(0), m_chunkCount(0), m_tableCapacity(0), m_allocator(), m_tableAllocator() {}
+
+		explicit SegmentedArray(ChunkAllocator &&allocator) :SegmentedArray() { m_allocator = std::move(allocator); }
+
+		SegmentedArray(ChunkAllocator &&allocator, TableAllocator &&tableAllocator)
+			:SegmentedArray()
+		{
+			m_allocator = std::move(allocator);
+			m_tableAllocator = std::move(tableAllocator);
+		}
+
+		SegmentedArray(const SegmentedArray&) = delete;
+		SegmentedArray& operator=(const SegmentedArray&) = delete;
+
+		SegmentedArray(SegmentedArray &&rhs) :SegmentedArray() { swap(rhs); }
+
+		SegmentedArray& operator=(SegmentedArray &&rhs)
+		{
+			if (this != &rhs)
+			{
+				swap(rhs);
+			}
+			return *this;
+		}
+
+		~SegmentedArray() { release(); }
+
+		void swap(SegmentedArray &rhs)
+		{
+			std::swap(m_chunks, rhs.m_chunks);
+			std::swap(m_size, rhs.m_size);
+			std::swap(m_chunkCount, rhs.m_chunkCount);
+			std::swap(m_tableCapacity, rhs.m_tableCapacity);
+			m_allocator.swap(rhs.m_allocator);
+			m_tableAllocator.swap(rhs.m_tableAllocator);
+		}
+
+		// returns the new element or nullptr if no chunk could be allocated
+		template<typename ...Args>
+		pointer push_back(Args&& ...args)
+		{
+			if (m_size == m_chunkCount * CHUNK && !addChunk())
+				return nullptr;
+
+			auto p = m_chunks[getChunkIndex(m_size)] + (m_size & ChunkMask);
+			new (p) T{ std::forward<Args>(args)... };
+			++m_size;
+
+			return p;
+		}
+
+		void pop_back()
+		{
+			VX_ASSERT(m_size != 0);
+			--m_size;
+			vx::destruct(m_chunks[getChunkIndex(m_size)] + (m_size & ChunkMask));
+		}
+
+		// allocates chunks up front, returns false if the allocator ran out
+		bool reserve(size_t count)
+		{
+			while (m_chunkCount * CHUNK < count)
+			{
+				if (!addChunk())
+					return false;
+			}
+			return true;
+		}
+
+		bool resize(size_t count)
+		{
+			if (count < m_size)
+			{
+				while (m_size != count)
+				{
+					pop_back();
+				}
+				return true;
+			}
+
+			if (!reserve(count))
+				return false;
+
+			while (m_size != count)
+			{
+				auto chunk = getChunkIndex(m_size);
+				auto first = m_size & ChunkMask;
+				auto last = (count - chunk * CHUNK < CHUNK) ? (count - chunk * CHUNK) : (size_t)CHUNK;
+
+				vx::uninitialized_default_n(m_chunks[chunk] + first, last - first);
+				m_size += last - first;
+			}
+			return true;
+		}
+
+		void clear()
+		{
+			forEachChunk([](T* elements, size_t count)
+			{
+				vx::destroy_n(elements, count);
+			});
+			m_size = 0;
+		}
+
+		// returns chunks past the last element to the allocator
+		void shrink_to_fit()
+		{
+			freeChunks((m_size + CHUNK - 1) / CHUNK);
+		}
+
+		void release()
+		{
+			clear();
+			freeChunks(0);
+
+			if (m_chunks)
+			{
+				m_tableAllocator.deallocate({ (u8*)m_chunks, sizeof(T*) * m_tableCapacity });
+				m_chunks = nullptr;
+				m_tableCapacity = 0;
+			}
+		}
+
+		reference operator[](size_t index)
+		{
+			VX_ASSERT(index < m_size);
+			return m_chunks[getChunkIndex(index)][index & ChunkMask];
+		}
+
+		const_reference operator[](size_t index) const
+		{
+			VX_ASSERT(index < m_size);
+			return m_chunks[getChunkIndex(index)][index & ChunkMask];
+		}
+
+		reference front() { return (*this)[0]; }
+		const_reference front() const { return (*this)[0]; }
+		reference back() { return (*this)[m_size - 1]; }
+		const_reference back() const { return (*this)[m_size - 1]; }
+
+		// number of chunks holding elements, only the last one can be partially filled
+		size_t getChunkCount() const { return (m_size + CHUNK - 1) / CHUNK; }
+
+		pointer getChunk(size_t chunkIndex, size_t* count)
+		{
+			auto first = chunkIndex * CHUNK;
+			*count = (m_size - first < CHUNK) ? (m_size - first) : (size_t)CHUNK;
+			return m_chunks[chunkIndex];
+		}
+
+		const_pointer getChunk(size_t chunkIndex, size_t* count) const
+		{
+			auto first = chunkIndex * CHUNK;
+			*count = (m_size - first < CHUNK) ? (m_size - first) : (size_t)CHUNK;
+			return m_chunks[chunkIndex];
+		}
+
+		// f(T* elements, size_t count) is called once per chunk with elements
+		template<typename F>
+		void forEachChunk(F &&f)
+		{
+			auto chunkCount = getChunkCount();
+			for (size_t i = 0; i < chunkCount; ++i)
+			{
+				size_t count = 0;
+				auto elements = getChunk(i, &count);
+				f(elements, count);
+			}
+		}
+
+		template<typename F>
+		void forEach(F &&f)
+		{
+			forEachChunk([&](T* elements, size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					f(elements[i]);
+				}
+			});
+		}
+
+		iterator begin() { return iterator(this, 0); }
+		iterator end() { return iterator(this, m_size); }
+		const_iterator begin() const { return const_iterator(this, 0); }
+		const_iterator end() const { return const_iterator(this, m_size); }
+
+		size_t size() const { return m_size; }
+		size_t capacity() const { return m_chunkCount * CHUNK; }
+		bool empty() const { return m_size == 0; }
+
+		ChunkAllocator& getAllocator() { return m_allocator; }
+	};
+}
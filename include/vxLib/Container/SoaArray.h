@@ -0,0 +1,301 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Mallocator.h>
+#include <vxLib/algorithm.h>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace vx
+{
+	template<typename T>
+	struct SoaSpan
+	{
+		T* ptr;
+		size_t count;
+
+		T* begin() const { return ptr; }
+		T* end() const { return ptr + count; }
+		size_t size() const { return count; }
+		T& operator[](size_t i) const { return ptr[i]; }
+	};
+
+	/*
+	structure of arrays, every field lives in its own 64 byte aligned array inside a single allocation.
+	span<I>() hands out one field as a contiguous array for kernels that only touch a few fields.
+	Growth goes through Allocator::reallocate and moves the field arrays with memmove, so fields need to be
+	trivially relocatable (vx::is_trivially_relocatable), this is checked at compile time.
+	*/
+	template<typename Allocator, typename ...Fields>
+	class SoaArray
+	{
+		typedef std::tuple<Fields...> FieldTuple;
+		typedef std::index_sequence_for<Fields...> FieldIndices;
+
+		enum : size_t
+		{
+			FieldCount = sizeof...(Fields),
+			FieldAlignment = 64
+		};
+
+		static_assert(FieldCount > 0, "");
+		static_assert(std::conjunction<std::negation<std::is_array<Fields>>...>::value, "wrap array fields in a struct");
+		static_assert(std::conjunction<vx::is_trivially_relocatable<Fields>...>::value, "fields are moved with memmove and need to be trivially relocatable");
+
+		u8* m_fields[FieldCount];
+		size_t m_size;
+		size_t m_capacity;
+		AllocatedBlock m_block;
+		Allocator m_allocator;
+
+	public:
+		template<size_t I>
+		using field_type = typename std::tuple_element<I, FieldTuple>::type;
+
+	private:
+		static size_t alignOffset(size_t offset, size_t alignment)
+		{
+			return getAlignedSize(offset, (alignment < FieldAlignment) ? (size_t)FieldAlignment : alignment);
+		}
+
+		// offsets[i] of every field array for capacity, returns the block size
+		static size_t getLayout(size_t capacity, size_t* offsets)
+		{
+			const size_t sizes[] = { sizeof(Fields)... };
+			const size_t alignments[] = { __alignof(Fields)... };
+
+			size_t offset = 0;
+			for (size_t i = 0; i < FieldCount; ++i)
+			{
+				offset = alignOffset(offset, alignments[i]);
+				offsets[i] = offset;
+				offset += sizes[i] * capacity;
+			}
+
+			return offset;
+		}
+
+		template<typename F, size_t ...I>
+		void forEachField(F &&f, std::index_sequence<I...>)
+		{
+			int dummy[] = { (f(data<I>()), 0)... };
+			(void)dummy;
+		}
+
+		template<typename F>
+		void forEachField(F &&f)
+		{
+			forEachField(std::forward<F>(f), FieldIndices());
+		}
+
+		template<size_t ...I, typename ...Args>
+		void constructAt(size_t index, std::index_sequence<I...>, Args&& ...args)
+		{
+			int dummy[] = { (new (data<I>() + index) field_type<I>(std::forward<Args>(args)), 0)... };
+			(void)dummy;
+		}
+
+		bool grow(size_t capacity)
+		{
+			size_t oldOffsets[FieldCount];
+			size_t newOffsets[FieldCount];
+			getLayout(m_capacity, oldOffsets);
+			auto blockSize = getLayout(capacity, newOffsets);
+
+			auto newBlock = (m_block.ptr == nullptr) ? m_allocator.allocate(blockSize, FieldAlignment) : m_allocator.reallocate(m_block, blockSize, FieldAlignment);
+			if (newBlock.ptr == nullptr)
+				return false;
+
+			// reallocate kept the old layout, every array moves up, so the last one goes first
+			const size_t sizes[] = { sizeof(Fields)... };
+			for (size_t i = FieldCount; i > 0; --i)
+			{
+				if (m_size != 0)
+					::memmove(newBlock.ptr + newOffsets[i - 1], newBlock.ptr + oldOffsets[i - 1], sizes[i - 1] * m_size);
+
+				m_fields[i - 1] = newBlock.ptr + newOffsets[i - 1];
+			}
+
+			m_block = newBlock;
+			m_capacity = capacity;
+			return true;
+		}
+
+	public:
+		SoaArray() :m_fields(), m_size(0), m_capacity(0), m_block(), m_allocator() {}
+
+		explicit SoaArray(Allocator &&allocator) :SoaArray() { m_allocator = std::move(allocator); }
+
+		SoaArray(Allocator &&allocator, size_t capacity) :SoaArray(std::move(allocator)) { reserve(capacity); }
+
+		SoaArray(const SoaArray&) = delete;
+		SoaArray& operator=(const SoaArray&) = delete;
+
+		SoaArray(SoaArray &&rhs) :SoaArray()
+		{
+			swap(rhs);
+		}
+
+		SoaArray& operator=(SoaArray &&rhs)
+		{
+			if (this != &rhs)
+			{
+				swap(rhs);
+			}
+			return *this;
+		}
+
+		~SoaArray()
+		{
+			release();
+		}
+
+		void swap(SoaArray &other)
+		{
+			for (size_t i = 0; i < FieldCount; ++i)
+			{
+				std::swap(m_fields[i], other.m_fields[i]);
+			}
+			std::swap(m_size, other.m_size);
+			std::swap(m_capacity, other.m_capacity);
+			std::swap(m_block, other.m_block);
+			m_allocator.swap(other.m_allocator);
+		}
+
+		bool reserve(size_t capacity)
+		{
+			if (capacity <= m_capacity)
+				return true;
+
+			return grow(capacity);
+		}
+
+		// returns false if the array could not grow
+		bool push_back(const Fields& ...values)
+		{
+			if (m_size == m_capacity && !grow((m_capacity < 8) ? 16 : m_capacity * 2))
+				return false;
+
+			constructAt(m_size, FieldIndices(), values...);
+			++m_size;
+
+			return true;
+		}
+
+		void pop_back()
+		{
+			VX_ASSERT(m_size != 0);
+			--m_size;
+
+			auto index = m_size;
+			forEachField([index](auto* field)
+			{
+				typedef typename std::remove_pointer<decltype(field)>::type T;
+				field[index].~T();
+			});
+		}
+
+		// keeps the order, moves every element behind index
+		void erase(size_t index)
+		{
+			VX_ASSERT(index < m_size);
+
+			--m_size;
+			auto count = m_size - index;
+			forEachField([index, count](auto* field)
+			{
+				vx::destruct(field + index);
+				vx::relocate_n(field + index + 1, count, field + index);
+			});
+		}
+
+		// moves the last element into index, O(1) but changes the order
+		void swap_remove(size_t index)
+		{
+			VX_ASSERT(index < m_size);
+
+			auto last = m_size - 1;
+			if (index != last)
+			{
+				forEachField([index, last](auto* field)
+				{
+					field[index] = std::move(field[last]);
+				});
+			}
+			pop_back();
+		}
+
+		void clear()
+		{
+			auto size = m_size;
+			forEachField([size](auto* field)
+			{
+				vx::destroy_n(field, size);
+			});
+			m_size = 0;
+		}
+
+		void release()
+		{
+			clear();
+
+			if (m_block.ptr)
+				m_allocator.deallocate(m_block);
+
+			m_block = { nullptr, 0 };
+			for (size_t i = 0; i < FieldCount; ++i)
+			{
+				m_fields[i] = nullptr;
+			}
+			m_capacity = 0;
+		}
+
+		template<size_t I>
+		field_type<I>* data() { return (field_type<I>*)m_fields[I]; }
+
+		template<size_t I>
+		const field_type<I>* data() const { return (const field_type<I>*)m_fields[I]; }
+
+		template<size_t I>
+		SoaSpan<field_type<I>> span() { return{ data<I>(), m_size }; }
+
+		template<size_t I>
+		SoaSpan<const field_type<I>> span() const { return{ data<I>(), m_size }; }
+
+		template<size_t I>
+		field_type<I>& get(size_t index) { return data<I>()[index]; }
+
+		template<size_t I>
+		const field_type<I>& get(size_t index) const { return data<I>()[index]; }
+
+		size_t size() const { return m_size; }
+		size_t capacity() const { return m_capacity; }
+		bool empty() const { return m_size == 0; }
+	};
+}
@@ -26,6 +26,8 @@ SOFTWARE.
 
 #include <vxLib/Allocator/Allocator.h>
 #include <vxLib/algorithm.h>
+#include <vxLib/Container/EytzingerIndex.h>
+#include <functional>
 
 namespace vx
 {
@@ -36,11 +38,14 @@ namespace vx
 		typedef T value_type;
 		typedef value_type* pointer;
 
+		static_assert(vx::is_trivially_relocatable<K>::value && vx::is_trivially_relocatable<T>::value, "keys and values are moved by reallocate and need to be trivially relocatable");
+
 		AllocatedBlock m_keyBlock;
 		AllocatedBlock m_dataBlock;
 		size_t m_size;
 		size_t m_capacity;
 		Allocator m_allocator;
+		EytzingerIndex<K, Cmp> m_searchIndex;
 
 		key_type* beginKey()
 		{
@@ -62,11 +67,75 @@ namespace vx
 			return beginKey() + m_size;
 		}
 
+		bool growBlock(AllocatedBlock* block, size_t size, size_t alignment)
+		{
+			auto newBlock = (block->ptr == nullptr) ? m_allocator.allocate(size, alignment) : m_allocator.reallocate(*block, size, alignment);
+			if (newBlock.ptr == nullptr)
+				return false;
+
+			*block = newBlock;
+			return true;
+		}
+
+		bool isEqual(const key_type &l, const key_type &r) const
+		{
+			return !Cmp()(l, r) && !Cmp()(r, l);
+		}
+
+		/*
+		merges count sorted keys that are not present yet, order[i] is the position of the i-th key in keys and values.
+		Runs backwards from the new end so every element moves once, slots past m_size are constructed.
+		*/
+		void mergeBackward(const key_type* keys, const value_type* values, const u32* order, size_t count)
+		{
+			auto keyPtr = beginKey();
+			auto dataPtr = begin();
+
+			auto dst = m_size + count;
+			auto src = m_size;
+			auto newIndex = count;
+			while (newIndex != 0)
+			{
+				--dst;
+				auto batchIndex = order[newIndex - 1];
+				if (src != 0 && Cmp()(keys[batchIndex], keyPtr[src - 1]))
+				{
+					--src;
+					if (dst >= m_size)
+					{
+						new (keyPtr + dst) key_type(std::move(keyPtr[src]));
+						new (dataPtr + dst) value_type(std::move(dataPtr[src]));
+					}
+					else
+					{
+						keyPtr[dst] = std::move(keyPtr[src]);
+						dataPtr[dst] = std::move(dataPtr[src]);
+					}
+				}
+				else
+				{
+					--newIndex;
+					if (dst >= m_size)
+					{
+						new (keyPtr + dst) key_type(keys[batchIndex]);
+						new (dataPtr + dst) value_type(values[batchIndex]);
+					}
+					else
+					{
+						keyPtr[dst] = keys[batchIndex];
+						dataPtr[dst] = values[batchIndex];
+					}
+				}
+			}
+
+			m_size += count;
+		}
+
 	public:
-		SortedArray() : m_keyBlock(), m_dataBlock(), m_size(0), m_capacity(0), m_allocator() {}
+		SortedArray() : m_keyBlock(), m_dataBlock(), m_size(0), m_capacity(0), m_allocator(), m_searchIndex() {}
 
 		SortedArray(Allocator &&alloc, size_t capacity)
-			: m_keyBlock(), m_dataBlock(), m_size(0), m_capacity(0), m_allocator(std::move(alloc))
+			: m_keyBlock(), m_dataBlock(), m_size(0), m_capacity(0), m_allocator(std::move(alloc)), m_searchIndex()
 		{
 			m_keyBlock = m_allocator.allocate(sizeof(key_type) * capacity, __alignof(key_type));
 			m_dataBlock = m_allocator.allocate(sizeof(value_type) * capacity, __alignof(value_type));
@@ -87,8 +156,11 @@ namespace vx
 			m_dataBlock(other.m_dataBlock),
 			m_size(other.m_size),
 			m_capacity(other.m_capacity),
-			m_allocator(std::move(other.m_allocator))
+			m_allocator(std::move(other.m_allocator)),
+			m_searchIndex()
 		{
+			m_searchIndex.swap(other.m_searchIndex);
+
 			other.m_keyBlock = { nullptr, 0 };
 			other.m_dataBlock = { nullptr, 0 };
 			other.m_size = 0;
@@ -118,13 +190,29 @@ namespace vx
 			std::swap(m_size, other.m_size);
 			std::swap(m_capacity, other.m_capacity);
 			m_allocator.swap(other.m_allocator);
+			m_searchIndex.swap(other.m_searchIndex);
 		}
 
+		// keys and values are moved with Allocator::reallocate, hence the static_assert on trivially relocatable types
+		bool reserve(size_t capacity)
+		{
+			if (capacity <= m_capacity)
+				return true;
+
+			if (!growBlock(&m_keyBlock, sizeof(key_type) * capacity, __alignof(key_type)) ||
+				!growBlock(&m_dataBlock, sizeof(value_type) * capacity, __alignof(value_type)))
+				return false;
+
+			m_capacity = capacity;
+			return true;
+		}
+
+		// returns end() if the array could not grow
 		template<typename ...Args>
 		pointer insert(const key_type &key, Args&&... args)
 		{
 			auto currentSize = m_size;
-			if (currentSize >= m_capacity)
+			if (currentSize >= m_capacity && !reserve((m_capacity < 4) ? 8 : m_capacity * 2))
 			{
 				return end();
 			}
@@ -149,13 +237,131 @@ namespace vx
 				std::rotate(dataPtr, dataPtrEnd - 1, dataPtrEnd);
 
 				++m_size;
+				m_searchIndex.invalidate();
 			}
 
 			return dataPtr;
 		}
 
+		/*
+		inserts count unsorted key/value pairs in O(count * log(count) + size()) instead of count rotations.
+		Keys that are already present or repeat within the batch keep the first value, same as insert.
+		Returns the number of inserted elements.
+		*/
+		size_t insert_range(const key_type* keys, const value_type* values, size_t count)
+		{
+			if (count == 0)
+				return 0;
+
+			auto orderBlock = m_allocator.allocate(sizeof(u32) * count, __alignof(u32));
+			if (orderBlock.ptr == nullptr)
+				return 0;
+
+			auto order = (u32*)orderBlock.ptr;
+			for (size_t i = 0; i < count; ++i)
+			{
+				order[i] = (u32)i;
+			}
+
+			std::stable_sort(order, order + count, [keys](u32 l, u32 r) { return Cmp()(keys[l], keys[r]); });
+
+			// drop duplicates within the batch and keys that exist already, single pass over both sorted ranges
+			auto keyPtr = beginKey();
+			size_t existing = 0;
+			size_t newCount = 0;
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto &key = keys[order[i]];
+				if (newCount != 0 && isEqual(keys[order[newCount - 1]], key))
+					continue;
+
+				while (existing < m_size && Cmp()(keyPtr[existing], key))
+				{
+					++existing;
+				}
+
+				if (existing < m_size && !Cmp()(key, keyPtr[existing]))
+					continue;
+
+				order[newCount++] = order[i];
+			}
+
+			size_t inserted = 0;
+			if (newCount != 0 && reserve(m_size + newCount))
+			{
+				mergeBackward(keys, values, order, newCount);
+				inserted = newCount;
+				m_searchIndex.invalidate();
+			}
+
+			m_allocator.deallocate(orderBlock);
+
+			return inserted;
+		}
+
+		// replaces the content, sorts a permutation of keys and gathers keys and values through it
+		size_t build_from_unsorted(const key_type* keys, const value_type* values, size_t count)
+		{
+			clear();
+			return insert_range(keys, values, count);
+		}
+
+		template<typename OtherAlloc>
+		size_t merge(const SortedArray<K, T, OtherAlloc, Cmp> &other)
+		{
+			return insert_range(other.keys(), other.data(), other.size());
+		}
+
+		/*
+		builds an eytzinger ordered copy of the keys that find and find_batch use until the next modification.
+		Worth it for read mostly arrays that do not fit into the cache.
+		*/
+		bool build_search_index()
+		{
+			return m_searchIndex.build(beginKey(), m_size, &m_allocator);
+		}
+
+		void release_search_index()
+		{
+			m_searchIndex.release(&m_allocator);
+		}
+
+		bool has_search_index() const
+		{
+			return !m_searchIndex.empty();
+		}
+
+		// results[i] is the value of keys[i] or end(), searches are interleaved when the search index is built
+		void find_batch(const key_type* keys, size_t count, pointer* results)
+		{
+			if (m_searchIndex.empty())
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					results[i] = find(keys[i]);
+				}
+				return;
+			}
+
+			enum : size_t { ChunkSize = 64 };
+			size_t positions[ChunkSize];
+			for (size_t first = 0; first < count; first += ChunkSize)
+			{
+				auto chunk = (count - first < ChunkSize) ? count - first : (size_t)ChunkSize;
+				m_searchIndex.find_batch(keys + first, chunk, positions);
+
+				for (size_t i = 0; i < chunk; ++i)
+				{
+					results[first + i] = begin() + positions[i];
+				}
+			}
+		}
+
 		pointer find(const key_type &key)
 		{
+			if (!m_searchIndex.empty())
+				return begin() + m_searchIndex.find(key);
+
 			auto keyPtrBegin = beginKey();
 			auto keyPtrEnd = endKey();
 
@@ -172,6 +378,9 @@ namespace vx
 
 		const pointer find(const key_type &key) const
 		{
+			if (!m_searchIndex.empty())
+				return begin() + m_searchIndex.find(key);
+
 			auto keyPtrBegin = beginKey();
 			auto keyPtrEnd = endKey();
 
@@ -196,22 +405,26 @@ namespace vx
 			vx::destruct(currentValue);
 			vx::destruct(currentKey);
 
-			vx::move(currentValue + 1, end(), currentValue);
-			vx::move(currentKey + 1, endKey(), currentKey);
-
 			--m_size;
+			vx::relocate_n(currentValue + 1, m_size - idx, currentValue);
+			vx::relocate_n(currentKey + 1, m_size - idx, currentKey);
+
+			m_searchIndex.invalidate();
 		}
 
 		void clear()
 		{
-			vx::destruct(begin(), end());
-			vx::destruct(beginKey(), endKey());
+			vx::destroy_n(begin(), m_size);
+			vx::destroy_n(beginKey(), m_size);
 
 			m_size = 0;
+			m_searchIndex.invalidate();
 		}
 
 		void release()
 		{
+			m_searchIndex.release(&m_allocator);
+
 			if (m_keyBlock.ptr)
 			{
 				clear();
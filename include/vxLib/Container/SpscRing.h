@@ -0,0 +1,224 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Allocator/Mallocator.h>
+#include <vxLib/algorithm.h>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace vx
+{
+	/*
+	bounded lock-free queue for exactly one producer and one consumer thread. The capacity is rounded up to a power of two.
+	Producer and consumer counters sit on their own cache lines and each side keeps a cached copy of the other
+	counter, so the shared lines are only touched when the cached value says the ring is full or empty.
+	initialize and release are not thread safe.
+	*/
+	template<typename T, typename Allocator = Mallocator>
+	class SpscRing
+	{
+		struct VX_ALIGN(64) ProducerState
+		{
+			std::atomic<size_t> tail;
+			size_t cachedHead;
+		};
+
+		struct VX_ALIGN(64) ConsumerState
+		{
+			std::atomic<size_t> head;
+			size_t cachedTail;
+		};
+
+		ProducerState m_producer;
+		ConsumerState m_consumer;
+		T* m_data;
+		size_t m_mask;
+		Allocator m_allocator;
+
+		// number of free slots seen by the producer, reloads the head only when the cached value is not enough
+		size_t getWritable(size_t tail, size_t count)
+		{
+			auto capacity = m_mask + 1;
+			auto writable = capacity - (tail - m_producer.cachedHead);
+			if (writable < count)
+			{
+				m_producer.cachedHead = m_consumer.head.load(std::memory_order_acquire);
+				writable = capacity - (tail - m_producer.cachedHead);
+			}
+			return writable;
+		}
+
+		size_t getReadable(size_t head, size_t count)
+		{
+			auto readable = m_consumer.cachedTail - head;
+			if (readable < count)
+			{
+				m_consumer.cachedTail = m_producer.tail.load(std::memory_order_acquire);
+				readable = m_consumer.cachedTail - head;
+			}
+			return readable;
+		}
+
+	public:
+		SpscRing() :m_data(nullptr), m_mask(0), m_allocator()
+		{
+			m_producer.tail.store(0, std::memory_order_relaxed);
+			m_producer.cachedHead = 0;
+			m_consumer.head.store(0, std::memory_order_relaxed);
+			m_consumer.cachedTail = 0;
+		}
+
+		explicit SpscRing(Allocator &&allocator) :SpscRing() { m_allocator = std::move(allocator); }
+
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		~SpscRing() { release(); }
+
+		bool initialize(size_t capacity)
+		{
+			VX_ASSERT(m_data == nullptr && capacity != 0);
+
+			size_t size = 1;
+			while (size < capacity)
+				size <<= 1;
+
+			auto block = m_allocator.allocate(sizeof(T) * size, (__alignof(T) < 64) ? 64 : __alignof(T));
+			if (block.ptr == nullptr)
+				return false;
+
+			m_data = (T*)block.ptr;
+			m_mask = size - 1;
+			return true;
+		}
+
+		// destroys queued elements and returns the storage
+		void release()
+		{
+			if (m_data == nullptr)
+				return;
+
+			auto head = m_consumer.head.load(std::memory_order_relaxed);
+			auto tail = m_producer.tail.load(std::memory_order_relaxed);
+			for (; head != tail; ++head)
+			{
+				vx::destruct(m_data + (head & m_mask));
+			}
+
+			m_allocator.deallocate({ (u8*)m_data, sizeof(T) * (m_mask + 1) });
+			m_data = nullptr;
+			m_mask = 0;
+			m_producer.tail.store(0, std::memory_order_relaxed);
+			m_producer.cachedHead = 0;
+			m_consumer.head.store(0, std::memory_order_relaxed);
+			m_consumer.cachedTail = 0;
+		}
+
+		// producer only
+		template<typename ...Args>
+		bool emplace(Args&& ...args)
+		{
+			auto tail = m_producer.tail.load(std::memory_order_relaxed);
+			if (getWritable(tail, 1) == 0)
+				return false;
+
+			new (m_data + (tail & m_mask)) T(std::forward<Args>(args)...);
+			m_producer.tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool push(const T &value) { return emplace(value); }
+		bool push(T &&value) { return emplace(std::move(value)); }
+
+		// producer only, copies up to count values and publishes them at once, returns the number pushed
+		size_t push_n(const T* values, size_t count)
+		{
+			auto tail = m_producer.tail.load(std::memory_order_relaxed);
+			auto writable = getWritable(tail, count);
+			count = (count < writable) ? count : writable;
+			if (count == 0)
+				return 0;
+
+			auto first = tail & m_mask;
+			auto firstCount = m_mask + 1 - first;
+			firstCount = (count < firstCount) ? count : firstCount;
+
+			std::uninitialized_copy_n(values, firstCount, m_data + first);
+			std::uninitialized_copy_n(values + firstCount, count - firstCount, m_data);
+
+			m_producer.tail.store(tail + count, std::memory_order_release);
+			return count;
+		}
+
+		// consumer only
+		bool pop(T* value)
+		{
+			auto head = m_consumer.head.load(std::memory_order_relaxed);
+			if (getReadable(head, 1) == 0)
+				return false;
+
+			auto p = m_data + (head & m_mask);
+			*value = std::move(*p);
+			vx::destruct(p);
+
+			m_consumer.head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only, moves up to count values to values and frees their slots at once, returns the number popped
+		size_t pop_n(T* values, size_t count)
+		{
+			auto head = m_consumer.head.load(std::memory_order_relaxed);
+			auto readable = getReadable(head, count);
+			count = (count < readable) ? count : readable;
+			if (count == 0)
+				return 0;
+
+			auto first = head & m_mask;
+			auto firstCount = m_mask + 1 - first;
+			firstCount = (count < firstCount) ? count : firstCount;
+
+			std::move(m_data + first, m_data + first + firstCount, values);
+			vx::destroy_n(m_data + first, firstCount);
+			std::move(m_data, m_data + count - firstCount, values + firstCount);
+			vx::destroy_n(m_data, count - firstCount);
+
+			m_consumer.head.store(head + count, std::memory_order_release);
+			return count;
+		}
+
+		// only exact when neither side is running
+		size_t size() const
+		{
+			return m_producer.tail.load(std::memory_order_acquire) - m_consumer.head.load(std::memory_order_acquire);
+		}
+
+		bool empty() const { return size() == 0; }
+		size_t capacity() const { return (m_data != nullptr) ? m_mask + 1 : 0; }
+	};
+}
@@ -167,13 +167,13 @@ namespace vx
 
 		void clear()
 		{
-			::memset(rhs.m_data, 0, COUNT);
+			::memset(m_data, 0, COUNT);
 			m_end = m_data;
 		}
 
 		const char* c_str() const { return m_data; }
 
-		constexpr u32 capacity() const { return COUNT };
+		constexpr u32 capacity() const { return COUNT; }
 	};
 
 	template<u32 N>
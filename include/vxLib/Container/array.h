@@ -37,6 +37,10 @@ namespace vx
 
 		typedef ArrayBase<T> MyBase;
 
+		using MyBase::m_begin;
+		using MyBase::m_end;
+		using MyBase::m_last;
+
 		enum { BUFFERSIZE = sizeof(T) * SIZE };
 
 	public:
@@ -46,6 +50,12 @@ namespace vx
 		typedef typename MyBase::reference reference;
 		typedef typename MyBase::const_reference const_reference;
 
+		using MyBase::begin;
+		using MyBase::end;
+		using MyBase::size;
+		using MyBase::capacity;
+		using MyBase::clear;
+
 	private:
 		u8 m_buffer[BUFFERSIZE];
 
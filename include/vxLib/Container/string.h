@@ -25,12 +25,185 @@ SOFTWARE.
 */
 
 #include <vxLib/Allocator/Mallocator.h>
+#include <vxLib/util/bitops.h>
 #include <algorithm>
 #include <cstring>
 #include <cctype>
+#include <utility>
+#ifndef _VX_PLATFORM_ANDROID
+#ifdef __AVX2__
+#include <immintrin.h>
+#define _VX_STRING_AVX2 1
+#else
+#include <emmintrin.h>
+#endif
+#endif
 
 namespace vx
 {
+	namespace detail
+	{
+		template<typename T>
+		inline T toLowerAscii(T c)
+		{
+			return (c >= 'A' && c <= 'Z') ? (T)(c | 0x20) : c;
+		}
+
+#ifndef _VX_PLATFORM_ANDROID
+		inline __m128i toLowerAscii(__m128i v)
+		{
+			auto upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+			return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+		}
+
+#ifdef _VX_STRING_AVX2
+		inline __m256i toLowerAscii(__m256i v)
+		{
+			auto upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+			return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+		}
+#endif
+#endif
+
+		// index of the first c in str[0, size) or size
+		template<typename T>
+		inline size_t stringFind(const T* str, size_t size, T c)
+		{
+			size_t i = 0;
+			while (i < size && str[i] != c)
+				++i;
+			return i;
+		}
+
+		// without sse the templates above handle char as well
+#ifndef _VX_PLATFORM_ANDROID
+		inline size_t stringFind(const char* str, size_t size, char c)
+		{
+			size_t i = 0;
+#ifdef _VX_STRING_AVX2
+			auto c32 = _mm256_set1_epi8(c);
+			for (; i + 32 <= size; i += 32)
+			{
+				auto mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(str + i)), c32));
+				if (mask != 0)
+					return i + ntz64(mask);
+			}
+#endif
+			auto c16 = _mm_set1_epi8(c);
+			for (; i + 16 <= size; i += 16)
+			{
+				auto mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(str + i)), c16));
+				if (mask != 0)
+					return i + ntz64(mask);
+			}
+
+			// the last block overlaps the checked range, characters before i are masked out
+			if (i < size && size >= 16)
+			{
+				auto first = size - 16;
+				auto mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(str + first)), c16));
+				mask &= ~0u << (i - first);
+				return (mask != 0) ? first + ntz64(mask) : size;
+			}
+
+			while (i < size && str[i] != c)
+				++i;
+			return i;
+		}
+#endif
+
+		// index of the first character that differs or size
+		template<bool IGNORE_CASE, typename T>
+		inline size_t stringMismatch(const T* a, const T* b, size_t size)
+		{
+			size_t i = 0;
+			while (i < size && (IGNORE_CASE ? toLowerAscii(a[i]) == toLowerAscii(b[i]) : a[i] == b[i]))
+				++i;
+			return i;
+		}
+
+#ifndef _VX_PLATFORM_ANDROID
+		template<bool IGNORE_CASE>
+		inline size_t stringMismatch(const char* a, const char* b, size_t size)
+		{
+			size_t i = 0;
+#ifdef _VX_STRING_AVX2
+			for (; i + 32 <= size; i += 32)
+			{
+				auto va = _mm256_loadu_si256((const __m256i*)(a + i));
+				auto vb = _mm256_loadu_si256((const __m256i*)(b + i));
+				if (IGNORE_CASE)
+				{
+					va = toLowerAscii(va);
+					vb = toLowerAscii(vb);
+				}
+
+				auto mask = ~(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+				if (mask != 0)
+					return i + ntz64(mask);
+			}
+#endif
+			for (; i + 16 <= size; i += 16)
+			{
+				auto va = _mm_loadu_si128((const __m128i*)(a + i));
+				auto vb = _mm_loadu_si128((const __m128i*)(b + i));
+				if (IGNORE_CASE)
+				{
+					va = toLowerAscii(va);
+					vb = toLowerAscii(vb);
+				}
+
+				auto mask = ~(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) & 0xffff;
+				if (mask != 0)
+					return i + ntz64(mask);
+			}
+
+			// everything before i matched, so the overlapping last block finds the first mismatch behind it
+			if (i < size && size >= 16)
+			{
+				auto first = size - 16;
+				auto va = _mm_loadu_si128((const __m128i*)(a + first));
+				auto vb = _mm_loadu_si128((const __m128i*)(b + first));
+				if (IGNORE_CASE)
+				{
+					va = toLowerAscii(va);
+					vb = toLowerAscii(vb);
+				}
+
+				auto mask = ~(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) & 0xffff;
+				return (mask != 0) ? first + ntz64(mask) : size;
+			}
+
+			while (i < size && (IGNORE_CASE ? toLowerAscii(a[i]) == toLowerAscii(b[i]) : a[i] == b[i]))
+				++i;
+			return i;
+		}
+#endif
+
+		template<bool IGNORE_CASE, typename T>
+		inline int stringCompare(const T* a, size_t sizeA, const T* b, size_t sizeB)
+		{
+			auto size = (sizeA < sizeB) ? sizeA : sizeB;
+			auto i = stringMismatch<IGNORE_CASE>(a, b, size);
+			if (i != size)
+			{
+				typedef typename std::make_unsigned<T>::type U;
+				auto ca = (U)(IGNORE_CASE ? toLowerAscii(a[i]) : a[i]);
+				auto cb = (U)(IGNORE_CASE ? toLowerAscii(b[i]) : b[i]);
+				return (ca < cb) ? -1 : 1;
+			}
+
+			return (sizeA < sizeB) ? -1 : (sizeA > sizeB) ? 1 : 0;
+		}
+	}
+
+	/*
+	32 byte string, short strings are stored inline and the last byte is the tag.
+	Inline the tag holds InlineLength - size, so it doubles as the terminator of a string of InlineLength characters,
+	heap strings set the HeapTag bit. The allocator is the base of the storage and adds no size if it is empty.
+	Heap memory grows through Allocator::reallocate. find and compare use SSE2 (AVX2 if enabled) for char strings.
+	The tag trick for wide characters assumes a little endian target.
+	*/
 	template<typename T, typename Allocator>
 	class basic_string
 	{
@@ -39,139 +212,167 @@ namespace vx
 		typedef T* pointer;
 		typedef const T* const_pointer;
 
-		enum { BUFFER_SIZE_BYTES = 16, BUFFER_LENGTH = BUFFER_SIZE_BYTES / sizeof(value_type) };
+		enum : size_t
+		{
+			ObjectBytes = 32,
+			BufferLength = ObjectBytes / sizeof(value_type),
+			InlineLength = BufferLength - 1,
+			TagIndex = ObjectBytes - 1,
+			Alignment = 16
+		};
 
-		union
+		enum : u8 { HeapTag = 0x80 };
+
+		static_assert(ObjectBytes % sizeof(value_type) == 0, "");
+
+		struct Heap
+		{
+			pointer ptr;
+			size_t blockSize;
+			u32 size;
+		};
+
+		struct Storage : public MyAllocator
 		{
-			vx::AllocatedBlock m_data;
-			value_type m_buffer[BUFFER_LENGTH];
+			union
+			{
+				Heap heap;
+				value_type buffer[BufferLength];
+				u8 bytes[ObjectBytes];
+			};
+
+			Storage() :MyAllocator() { setEmpty(); }
+			explicit Storage(MyAllocator &&alloc) :MyAllocator(std::move(alloc)) { setEmpty(); }
+
+			void setEmpty()
+			{
+				buffer[0] = 0;
+				bytes[TagIndex] = (u8)InlineLength;
+			}
 		};
-		u32 m_size;
-		u32 m_capacity;
-		MyAllocator m_allocator;
 
-		size_t strlen(const char* str)
+		Storage m_storage;
+
+		static_assert(sizeof(Heap) < ObjectBytes, "");
+
+		static size_t strlen(const char* str)
 		{
 			return ::strlen(str);
 		}
 
-		size_t strlen(const wchar_t* str)
+		static size_t strlen(const wchar_t* str)
 		{
 			return ::wcslen(str);
 		}
 
+		MyAllocator& getAllocator() { return m_storage; }
+
+		bool isInline() const { return (m_storage.bytes[TagIndex] & HeapTag) == 0; }
+
 		pointer getPtr()
 		{
-			return (m_capacity == BUFFER_LENGTH) ? m_buffer : reinterpret_cast<pointer>(m_data.ptr);
+			return isInline() ? m_storage.buffer : m_storage.heap.ptr;
 		}
 
 		const_pointer getPtr() const
 		{
-			return (m_capacity == BUFFER_LENGTH) ? m_buffer : reinterpret_cast<const_pointer>(m_data.ptr);
-		}
-
-		void release()
-		{
-			if (m_capacity > BUFFER_LENGTH)
-			{
-				m_allocator.deallocate(m_data);
-				m_data = { nullptr, 0 };
-
-				m_capacity = 0;
-				m_size = 0;
-			}
+			return isInline() ? m_storage.buffer : m_storage.heap.ptr;
 		}
 
-		void swapPtr(basic_string &rhs)
+		// writes the terminator
+		void setSize(u32 size)
 		{
-			if (rhs.m_capacity == BUFFER_LENGTH &&
-				m_capacity == BUFFER_LENGTH)
+			if (isInline())
 			{
-				value_type buffer[BUFFER_LENGTH];
-
-				::memcpy(buffer, rhs.m_buffer, BUFFER_SIZE_BYTES);
-				::memcpy(rhs.m_buffer, m_buffer, BUFFER_SIZE_BYTES);
-				::memcpy(m_buffer, buffer, BUFFER_SIZE_BYTES);
+				m_storage.buffer[size] = 0;
+				m_storage.bytes[TagIndex] = (u8)(InlineLength - size);
 			}
 			else
 			{
-				std::swap(m_data, rhs.m_data);
+				m_storage.heap.ptr[size] = 0;
+				m_storage.heap.size = size;
 			}
 		}
 
-		void copyConstructData(const basic_string &rhs)
+		// makes room for length characters and the terminator
+		bool grow(u32 length)
 		{
-			if (rhs.m_capacity == BUFFER_LENGTH)
+			auto bytes = (size_t(length) + 1) * sizeof(value_type);
+			if (isInline())
 			{
-				::memcpy(m_buffer, rhs.m_buffer, BUFFER_SIZE_BYTES);
+				auto size = this->size();
+				auto block = getAllocator().allocate(bytes, Alignment);
+				if (block.ptr == nullptr)
+					return false;
+
+				::memcpy(block.ptr, m_storage.buffer, (size + 1) * sizeof(value_type));
+				m_storage.heap.ptr = (pointer)block.ptr;
+				m_storage.heap.blockSize = block.size;
+				m_storage.heap.size = size;
+				m_storage.bytes[TagIndex] = HeapTag;
 			}
 			else
 			{
-				auto strSize = rhs.m_size;
-				auto newCapacity = (rhs.m_size + 1);
-				auto allocSizeBytes = newCapacity * sizeof(value_type);
+				auto block = getAllocator().reallocate({ (u8*)m_storage.heap.ptr, m_storage.heap.blockSize }, bytes, Alignment);
+				if (block.ptr == nullptr)
+					return false;
 
-				m_allocator.deallocate(m_data);
-				auto allocatedBlock = m_allocator.allocate(allocSizeBytes, 4);
+				m_storage.heap.ptr = (pointer)block.ptr;
+				m_storage.heap.blockSize = block.size;
+			}
+			return true;
+		}
 
-				::memcpy(allocatedBlock.ptr, rhs.m_data.ptr, allocSizeBytes);
+		// doubles so appending a character at a time stays amortized O(1)
+		bool growFor(size_t length)
+		{
+			auto cap = capacity();
+			if (length <= cap)
+				return true;
 
-				m_data = allocatedBlock;
-				m_size = strSize;
-				m_capacity = static_cast<u32>(allocatedBlock.size / sizeof(value_type));
-			}
+			auto newCapacity = (length < cap * 2) ? cap * 2 : length;
+			return grow(static_cast<u32>(newCapacity));
 		}
 
-		void moveConstructData(basic_string &rhs)
+		void release()
 		{
-			if (rhs.m_capacity == BUFFER_LENGTH)
+			if (!isInline())
 			{
-				::memcpy(m_buffer, rhs.m_buffer, BUFFER_SIZE_BYTES);
-			}
-			else
-			{
-				std::swap(m_data, rhs.m_data);
-				rhs.m_data = {nullptr, 0};
+				getAllocator().deallocate({ (u8*)m_storage.heap.ptr, m_storage.heap.blockSize });
+				m_storage.setEmpty();
 			}
 		}
 
 	public:
-		basic_string() :m_data(), m_size(0), m_capacity(BUFFER_LENGTH), m_allocator() {}
-		explicit basic_string(MyAllocator &&alloc) :m_data(), m_size(0), m_capacity(BUFFER_LENGTH), m_allocator(std::move(alloc)) {}
+		enum : u32 { npos = 0xffffffff };
+
+		basic_string() :m_storage() {}
+		explicit basic_string(MyAllocator &&alloc) :m_storage(std::move(alloc)) {}
 
 		explicit basic_string(const_pointer str)
-			:m_data(),
-			m_size(0),
-			m_capacity(BUFFER_LENGTH)
+			:m_storage()
 		{
 			assign(str);
 		}
 
 		explicit basic_string(value_type c)
-			:m_data(),
-			m_size(1),
-			m_capacity(BUFFER_LENGTH)
+			:m_storage()
 		{
-			m_buffer[0] = c;
-			m_buffer[1] = 0;
+			m_storage.buffer[0] = c;
+			setSize(1);
 		}
 
 		basic_string(const basic_string &rhs)
-			:m_data(),
-			m_size(rhs.m_size),
-			m_capacity(BUFFER_LENGTH)
+			:m_storage()
 		{
-			copyConstructData(rhs);
+			assign(rhs.c_str(), rhs.size());
 		}
 
 		basic_string(basic_string &&rhs)
-			:m_data(),
-			m_size(rhs.m_size),
-			m_capacity(rhs.m_capacity)
+			:m_storage(std::move(rhs.getAllocator()))
 		{
-			moveConstructData(rhs);
-			rhs.m_size = 0;
-			rhs.m_capacity = BUFFER_LENGTH;
+			::memcpy(m_storage.bytes, rhs.m_storage.bytes, ObjectBytes);
+			rhs.m_storage.setEmpty();
 		}
 
 		~basic_string()
@@ -198,32 +399,22 @@ namespace vx
 		{
 			if (this != &rhs)
 			{
-				swapPtr(rhs);
-				std::swap(m_size, rhs.m_size);
-				std::swap(m_capacity, rhs.m_capacity);
+				u8 tmp[ObjectBytes];
+				::memcpy(tmp, m_storage.bytes, ObjectBytes);
+				::memcpy(m_storage.bytes, rhs.m_storage.bytes, ObjectBytes);
+				::memcpy(rhs.m_storage.bytes, tmp, ObjectBytes);
+				getAllocator().swap(rhs.getAllocator());
 			}
 			return *this;
 		}
 
-		void reserve(u32 cap)
+		// room for length characters without allocating
+		void reserve(u32 length)
 		{
-			if (cap <= m_capacity)
-				return;
-
-			auto currentSize = m_size;
-			auto allocSizeBytes = cap * sizeof(value_type);
-			auto newData = m_allocator.allocate(allocSizeBytes, 4);
-
-			::memcpy(newData.ptr, getPtr(), (currentSize + 1) * sizeof(value_type));
-			newData.ptr[currentSize] = 0;
-
-			if (BUFFER_LENGTH< m_capacity)
+			if (length > capacity())
 			{
-				m_allocator.deallocate(m_data);
+				grow(length);
 			}
-
-			m_data = newData;
-			m_capacity = static_cast<u32>(newData.size / sizeof(value_type));
 		}
 
 		void assign(const_pointer str)
@@ -233,29 +424,21 @@ namespace vx
 
 		void assign(const_pointer str, u32 size)
 		{
-			auto strSize = size + 1;
-			if (strSize > m_capacity)
-			{
-				reserve(strSize);
-			}
+			if (size > capacity() && !grow(size))
+				return;
 
-			auto dst = getPtr();
-			::memcpy(dst, str, size * sizeof(value_type));
-			dst[size] = '\0';
-			m_size = size;
+			::memmove(getPtr(), str, size * sizeof(value_type));
+			setSize(size);
 		}
 
 		void push_back(value_type c)
 		{
-			auto newSize = m_size + 2;
-			if (newSize > m_capacity)
-			{
-				reserve((u32)(newSize * 1.5f) + 1);
-			}
+			auto size = this->size();
+			if (!growFor(size + 1))
+				return;
 
-			auto dst = getPtr();
-			dst[m_size++] = c;
-			dst[m_size] = 0;
+			getPtr()[size] = c;
+			setSize(size + 1);
 		}
 
 		void append(const basic_string &str)
@@ -270,34 +453,103 @@ namespace vx
 
 		void append(const_pointer str, size_t size)
 		{
-			auto currentSize = m_size;
+			auto currentSize = this->size();
 			auto newSize = currentSize + size;
-			auto reqSize = newSize + 1;
-			if (reqSize > m_capacity)
-			{
-				reserve(static_cast<u32>(reqSize * 2));
-			}
+			// str can point into this string
+			auto offset = str - getPtr();
+			bool isSelf = (offset >= 0 && (size_t)offset <= currentSize);
+			if (!growFor(newSize))
+				return;
 
-			auto copySize = size * sizeof(value_type);
 			auto dst = getPtr();
-			::memcpy(&dst[currentSize], str, copySize);
-			dst[newSize] = 0;
+			::memmove(&dst[currentSize], isSelf ? dst + offset : str, size * sizeof(value_type));
+			setSize(static_cast<u32>(newSize));
+		}
 
-			m_size = static_cast<u32>(newSize);
+		void clear()
+		{
+			setSize(0);
 		}
 
 		pointer begin() { return getPtr(); }
 		const_pointer begin() const { return getPtr(); }
 
-		pointer end() { return getPtr() + m_size; }
-		const_pointer end() const { return getPtr() + m_size; }
+		pointer end() { return getPtr() + size(); }
+		const_pointer end() const { return getPtr() + size(); }
+
+		// characters that fit without allocating, not counting the terminator
+		u32 capacity() const
+		{
+			return isInline() ? (u32)InlineLength : (u32)(m_storage.heap.blockSize / sizeof(value_type) - 1);
+		}
+
+		u32 size() const
+		{
+			return isInline() ? (u32)(InlineLength - m_storage.bytes[TagIndex]) : m_storage.heap.size;
+		}
 
-		u32 capacity() const { return m_capacity; }
-		u32 size() const { return m_size; }
+		bool empty() const { return size() == 0; }
 
 		pointer c_str() { return getPtr(); }
 		const_pointer c_str() const { return getPtr(); }
 
+		u32 find(value_type c, u32 pos = 0) const
+		{
+			auto sz = size();
+			if (pos >= sz)
+				return npos;
+
+			auto index = pos + detail::stringFind(getPtr() + pos, sz - pos, c);
+			return (index == sz) ? (u32)npos : (u32)index;
+		}
+
+		u32 find(const_pointer str, u32 length, u32 pos) const
+		{
+			auto sz = size();
+			if (pos > sz || length > sz - pos)
+				return npos;
+
+			if (length == 0)
+				return pos;
+
+			// scans for the first character, then compares the rest
+			auto ptr = getPtr();
+			auto last = sz - length + 1;
+			while (pos < last)
+			{
+				pos += (u32)detail::stringFind(ptr + pos, last - pos, str[0]);
+				if (pos == last)
+					break;
+
+				if (detail::stringMismatch<false>(ptr + pos + 1, str + 1, length - 1) == length - 1)
+					return pos;
+
+				++pos;
+			}
+			return npos;
+		}
+
+		u32 find(const_pointer str, u32 pos = 0) const { return find(str, (u32)strlen(str), pos); }
+		u32 find(const basic_string &str, u32 pos = 0) const { return find(str.c_str(), str.size(), pos); }
+
+		// <0, 0 or >0 like strcmp, characters compare as unsigned
+		int compare(const_pointer str, u32 length) const { return detail::stringCompare<false>(getPtr(), size(), str, length); }
+		int compare(const basic_string &str) const { return compare(str.c_str(), str.size()); }
+
+		// only ASCII letters are folded
+		int compareIgnoreCase(const_pointer str, u32 length) const { return detail::stringCompare<true>(getPtr(), size(), str, length); }
+		int compareIgnoreCase(const basic_string &str) const { return compareIgnoreCase(str.c_str(), str.size()); }
+
+		bool equals(const basic_string &str) const
+		{
+			return size() == str.size() && detail::stringMismatch<false>(getPtr(), str.c_str(), size()) == size();
+		}
+
+		bool equalsIgnoreCase(const basic_string &str) const
+		{
+			return size() == str.size() && detail::stringMismatch<true>(getPtr(), str.c_str(), size()) == size();
+		}
+
 		void strip(value_type c)
 		{
 			auto ptr = getPtr();
@@ -315,8 +567,7 @@ namespace vx
 				}
 			}
 
-			ptr[sz] = 0;
-			m_size = sz;
+			setSize(sz);
 		}
 
 		void toLowerCase()
@@ -328,6 +579,24 @@ namespace vx
 	typedef basic_string<char, Mallocator> String;
 	typedef basic_string<wchar_t, Mallocator> wstring;
 
+	template<typename T, typename Allocator>
+	inline bool operator==(const basic_string<T, Allocator> &lhs, const basic_string<T, Allocator> &rhs)
+	{
+		return lhs.equals(rhs);
+	}
+
+	template<typename T, typename Allocator>
+	inline bool operator!=(const basic_string<T, Allocator> &lhs, const basic_string<T, Allocator> &rhs)
+	{
+		return !lhs.equals(rhs);
+	}
+
+	template<typename T, typename Allocator>
+	inline bool operator<(const basic_string<T, Allocator> &lhs, const basic_string<T, Allocator> &rhs)
+	{
+		return lhs.compare(rhs) < 0;
+	}
+
 	template<typename T, typename Allocator>
 	inline basic_string<T, Allocator> operator+(const basic_string<T, Allocator> &lhs, const basic_string<T, Allocator> &rhs)
 	{
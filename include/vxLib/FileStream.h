@@ -1,7 +1,7 @@
 #pragma once
 
 #include <vxLib/Stream.h>
-#include <vxlib/file.h>
+#include <vxLib/File.h>
 
 namespace vx
 {
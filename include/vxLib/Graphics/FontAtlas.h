@@ -47,11 +47,13 @@ namespace vx
 		class FontAtlas
 		{
 			FontAtlasEntry* m_data;
-			FontAtlasEntry* m_end;
+			u32 m_entryCount;
 			size_t m_allocatedSize;
 
 			FontAtlasEntry readEntry(std::ifstream &infile);
 			size_t readEntry(const char *ptr, FontAtlasEntry &entry);
+			// sorts m_data[1..m_entryCount] in place into eytzinger order
+			void buildSearchLayout();
 
 		public:
 			FontAtlas();
@@ -1,4 +1,4 @@
-#include <vxlib/types.h>
+#include <vxLib/types.h>
 
 namespace vx
 {
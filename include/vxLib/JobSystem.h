@@ -0,0 +1,155 @@
+#pragma once
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vxLib/Container/ArrayBase.h>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace vx
+{
+	// fork/join counter, run increments it and it drops back once the job finished, wait on it to join
+	struct JobCounter
+	{
+		std::atomic<u32> value;
+
+		JobCounter() :value(0) {}
+
+		bool isDone() const { return value.load(std::memory_order_acquire) == 0; }
+	};
+
+	struct Job
+	{
+		void(*execute)(Job*);
+		JobCounter* counter;
+	};
+
+	namespace detail
+	{
+		template<typename F>
+		struct JobImpl : public Job
+		{
+			F function;
+
+			template<typename G>
+			explicit JobImpl(G &&g) :function(std::forward<G>(g)) {}
+
+			static void executeImpl(Job* job)
+			{
+				auto p = static_cast<JobImpl*>(job);
+				p->function();
+				p->~JobImpl();
+			}
+		};
+	}
+
+	/*
+	work stealing job scheduler. Every worker owns a fixed size Chase-Lev deque, it pushes and pops at the bottom
+	while idle workers steal from the top. Jobs are placed into a per worker LinearAllocator frame that is reset
+	with resetFrame once no job is in flight, so queueing a job never touches the heap.
+	The thread calling initialize is worker 0. Calling run from any other thread, running out of frame memory
+	or a full deque executes the job inline, so callers always get fork/join semantics.
+	*/
+	class JobSystem
+	{
+		struct Data;
+
+		Data* m_data;
+
+		void* allocateJob(size_t size, size_t alignment);
+		void submit(Job* job);
+
+	public:
+		enum : u32 { InvalidWorker = 0xffffffff };
+
+		JobSystem();
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		// workerCount includes the calling thread, 0 uses one worker per hardware thread
+		bool initialize(u32 workerCount, size_t frameBytesPerWorker = 1 MBYTE, u32 queueCapacity = 4096);
+		// waits for queued jobs and joins the worker threads
+		void shutdown();
+
+		// f() runs on any worker, counter can be nullptr
+		template<typename F>
+		void run(F &&f, JobCounter* counter)
+		{
+			typedef detail::JobImpl<typename std::decay<F>::type> Impl;
+
+			auto ptr = allocateJob(sizeof(Impl), __alignof(Impl));
+			if (ptr == nullptr)
+			{
+				f();
+				return;
+			}
+
+			auto job = new (ptr) Impl(std::forward<F>(f));
+			job->execute = &Impl::executeImpl;
+			job->counter = counter;
+			submit(job);
+		}
+
+		// executes queued jobs on the calling thread until counter reaches zero
+		void wait(JobCounter* counter);
+
+		// gives the job memory of all workers back, no job may be queued or running
+		void resetFrame();
+
+		// f(T* first, T* last) is called for consecutive ranges of at most grainSize elements, the caller takes the first range
+		template<typename T, typename F>
+		void parallel_for(T* data, size_t count, size_t grainSize, F &&f)
+		{
+			if (count == 0)
+				return;
+
+			grainSize = (grainSize == 0) ? 1 : grainSize;
+
+			JobCounter counter;
+			for (size_t first = grainSize; first < count; first += grainSize)
+			{
+				auto last = (count - first < grainSize) ? count : first + grainSize;
+				run([&f, data, first, last]() { f(data + first, data + last); }, &counter);
+			}
+
+			f(data, data + ((count < grainSize) ? count : grainSize));
+			wait(&counter);
+		}
+
+		template<typename T, typename F>
+		void parallel_for(ArrayBase<T> &array, size_t grainSize, F &&f)
+		{
+			parallel_for(array.begin(), array.size(), grainSize, std::forward<F>(f));
+		}
+
+		u32 getWorkerCount() const;
+		// index of the calling thread or InvalidWorker
+		u32 getCurrentWorker() const;
+	};
+}
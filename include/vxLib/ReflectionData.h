@@ -3,6 +3,7 @@
 
 #include <vxLib/ReflectionManager.h>
 #include <vxLib/hash.h>
+#include <utility>
 
 namespace vx
 {
@@ -89,6 +89,9 @@ namespace vx
 		constexpr u32 getHash() const { return m_hash; }
 	};
 
+	template<typename T>
+	constexpr TypeInfoBase type_info();
+
 	template<size_t SZ>
 	struct TypeInfo : public TypeInfoBase
 	{
@@ -240,7 +243,7 @@ namespace vx
 		{
 			static_assert(std::is_base_of<Parent, Child>::value, "");
 
-			inline const TypeInfo* operator()() { return &::vx::type_info<Parent>(); }
+			inline const TypeInfoBase* operator()() { return &::vx::type_info<Parent>(); }
 		};
 
 		template<typename T>
@@ -288,28 +291,25 @@ namespace vx
 			}
 		};
 
-		namespace detail
+		template<u32 SIZE>
+		struct GetTypeInfo<vx::StringArray<SIZE>>
 		{
-			template<u32 SIZE>
-			struct GetTypeInfo<vx::StringArray<SIZE>>
+			static const auto& get()
 			{
-				static const auto& get()
+				static const auto typeInfo
 				{
-					static const auto typeInfo
-					{
-						get_constexpr()
-					};
-					return typeInfo;
-				}
-
-				constexpr static auto get_constexpr()
-				{
-					return getTypeInfo(concat("vx::StringArray<", IntToString<SIZE>::get().data, ">"),
-						sizeof(vx::StringArray<SIZE>),
-						__alignof(vx::StringArray<SIZE>));
-				}
-			};
-		}
+					get_constexpr()
+				};
+				return typeInfo;
+			}
+
+			constexpr static auto get_constexpr()
+			{
+				return getTypeInfo(concat("vx::StringArray<", IntToString<SIZE>::get().data, ">"),
+					sizeof(vx::StringArray<SIZE>),
+					__alignof(vx::StringArray<SIZE>));
+			}
+		};
 	}
 
 	template<typename T>
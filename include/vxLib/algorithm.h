@@ -26,6 +26,10 @@ SOFTWARE.
 
 #include <vxLib/type_traits.h>
 #include <algorithm>
+#include <string.h>
+#ifndef _VX_PLATFORM_ANDROID
+#include <emmintrin.h>
+#endif
 
 namespace vx
 {
@@ -203,25 +207,145 @@ namespace vx
 		new (dst)T{ std::forward<Args>(args)... };
 	}
 
+	namespace detail
+	{
+		// above this size stores bypass the cache, the data would only evict the working set
+		enum : size_t { StreamingStoreThreshold = 4 MBYTE };
+
+		inline void streamFill(u8* dst, int value, size_t size)
+		{
+#ifndef _VX_PLATFORM_ANDROID
+			if (size >= StreamingStoreThreshold)
+			{
+				auto head = (16 - ((size_t)dst & 15)) & 15;
+				::memset(dst, value, head);
+				dst += head;
+				size -= head;
+
+				auto v = _mm_set1_epi8((char)value);
+				auto last = dst + (size & ~(size_t)63);
+				for (; dst != last; dst += 64)
+				{
+					_mm_stream_si128((__m128i*)dst, v);
+					_mm_stream_si128((__m128i*)(dst + 16), v);
+					_mm_stream_si128((__m128i*)(dst + 32), v);
+					_mm_stream_si128((__m128i*)(dst + 48), v);
+				}
+				_mm_sfence();
+				size &= 63;
+			}
+#endif
+			::memset(dst, value, size);
+		}
+
+		// src and dst can overlap, only disjoint ranges use streaming stores
+		inline void streamMove(u8* dst, const u8* src, size_t size)
+		{
+#ifndef _VX_PLATFORM_ANDROID
+			if (size >= StreamingStoreThreshold && (dst + size <= src || src + size <= dst))
+			{
+				auto head = (16 - ((size_t)dst & 15)) & 15;
+				::memcpy(dst, src, head);
+				dst += head;
+				src += head;
+				size -= head;
+
+				auto last = dst + (size & ~(size_t)63);
+				for (; dst != last; dst += 64, src += 64)
+				{
+					auto a = _mm_loadu_si128((const __m128i*)src);
+					auto b = _mm_loadu_si128((const __m128i*)(src + 16));
+					auto c = _mm_loadu_si128((const __m128i*)(src + 32));
+					auto d = _mm_loadu_si128((const __m128i*)(src + 48));
+					_mm_stream_si128((__m128i*)dst, a);
+					_mm_stream_si128((__m128i*)(dst + 16), b);
+					_mm_stream_si128((__m128i*)(dst + 32), c);
+					_mm_stream_si128((__m128i*)(dst + 48), d);
+				}
+				_mm_sfence();
+				size &= 63;
+			}
+#endif
+			::memmove(dst, src, size);
+		}
+	}
+
+	// value initializes count elements in raw memory
 	template<typename T>
 	typename std::enable_if<
-		std::is_trivially_constructible<T>::value, void>::type
-		construct(T* __restrict begin, T* __restrict end)
+		std::is_trivially_default_constructible<T>::value, void>::type
+		uninitialized_default_n(T* dst, size_t count)
 	{
-		::memset(begin, 0, end - begin);
+		detail::streamFill(reinterpret_cast<u8*>(dst), 0, sizeof(T) * count);
 	}
 
 	template<typename T>
 	typename std::enable_if<
-		!std::is_trivially_constructible<T>::value, void>::type
-		construct(T* __restrict begin, T* __restrict end)
+		!std::is_trivially_default_constructible<T>::value, void>::type
+		uninitialized_default_n(T* dst, size_t count)
 	{
-		while (begin != end)
+		for (auto last = dst + count; dst != last; ++dst)
 		{
-			new (begin++) T{};
+			new (dst) T{};
 		}
 	}
 
+	// moves count elements to raw memory at dst and destroys the source, src and dst can overlap
+	template<typename T>
+	typename std::enable_if<
+		vx::is_trivially_relocatable<T>::value, void>::type
+		relocate_n(T* src, size_t count, T* dst)
+	{
+		detail::streamMove(reinterpret_cast<u8*>(dst), reinterpret_cast<const u8*>(src), sizeof(T) * count);
+	}
+
+	template<typename T>
+	typename std::enable_if<
+		!vx::is_trivially_relocatable<T>::value, void>::type
+		relocate_n(T* src, size_t count, T* dst)
+	{
+		if (dst < src)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				new (dst + i) T(std::move(src[i]));
+				src[i].~T();
+			}
+		}
+		else if (dst > src)
+		{
+			for (size_t i = count; i > 0; --i)
+			{
+				new (dst + i - 1) T(std::move(src[i - 1]));
+				src[i - 1].~T();
+			}
+		}
+	}
+
+	template<typename T>
+	typename std::enable_if<
+		std::is_trivially_destructible<T>::value, void>::type
+		destroy_n(T*, size_t)
+	{
+	}
+
+	template<typename T>
+	typename std::enable_if<
+		!std::is_trivially_destructible<T>::value, void>::type
+		destroy_n(T* p, size_t count)
+	{
+		for (auto last = p + count; p != last; ++p)
+		{
+			p->~T();
+		}
+	}
+
+	template<typename T>
+	void construct(T* __restrict begin, T* __restrict end)
+	{
+		uninitialized_default_n(begin, end - begin);
+	}
+
 	template<typename T, typename Cmp>
 	inline void sort_subrange(T f, T l, T sf, T sl, Cmp cmp)
 	{
@@ -260,6 +384,18 @@ namespace vx
 		return std::rotate(stable_partition_position(f, m, p), m, stable_partition_position(m, l, p));
 	}
 
+	template<size_t LHS, size_t RHS>
+	struct Is_Greater
+	{
+		enum { value = (LHS > RHS) };
+	};
+
+	template<size_t LHS, size_t RHS>
+	struct Is_Less
+	{
+		enum { value = (LHS < RHS) };
+	};
+
 	namespace detail
 	{
 		template<bool b, size_t LHS, size_t RHS>
@@ -349,18 +485,6 @@ namespace vx
 		};
 	}
 
-	template<size_t LHS, size_t RHS>
-	struct Is_Greater
-	{
-		enum { value = (LHS > RHS) };
-	};
-
-	template<size_t LHS, size_t RHS>
-	struct Is_Less
-	{
-		enum { value = (LHS < RHS) };
-	};
-
 	template<size_t ...Args>
 	struct MAX
 	{
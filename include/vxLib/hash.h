@@ -31,6 +31,9 @@ namespace vx
 {
 	typedef u32 hash_type;
 
+	template<size_t LEN>
+	constexpr hash_type murmurhash(const char(&key)[LEN]);
+
 	namespace detail
 	{
 		constexpr u32 get_k_1(u32 k)
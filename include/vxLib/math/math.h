@@ -24,7 +24,7 @@ SOFTWARE.
 */
 
 #include <vxLib/math/half.h>
-#ifdef _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 #include <x86intrin.h>
 #else
 #include <intrin.h>
@@ -311,6 +311,26 @@ namespace vx
 #if _VX_PLATFORM_ANDROID
 #define bsf32 __builtin_ctz
 #define bsr32 __builtin_clz
+#elif _VX_PLATFORM_LINUX
+	inline u32 bsf32(const u32 x)
+	{
+		return __builtin_ctz(x);
+	}
+
+	inline u32 bsr32(const u32 x)
+	{
+		return 31 - __builtin_clz(x);
+	}
+
+	inline u32 bsf64(const u64 x)
+	{
+		return __builtin_ctzll(x);
+	}
+
+	inline u32 bsr64(const u64 x)
+	{
+		return 63 - __builtin_clzll(x);
+	}
 #else
 	inline u32 bsf32(const u32 x)
 	{
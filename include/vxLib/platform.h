@@ -8,6 +8,14 @@
 #endif
 #elif __ANDROID__
 #define _VX_PLATFORM_ANDROID 1
+#elif __linux__
+#define _VX_PLATFORM_LINUX 1
+#endif
+
+#if defined(__clang__)
+#define _VX_CLANG
+#elif defined(__GNUC__) && !defined(__INTEL_COMPILER)
+#define _VX_GCC
 #endif
 
 #if defined __i386 || defined __i386__ || defined _X86_ || defined _M_IX86
@@ -26,6 +34,8 @@
 #endif
 #if _VX_PLATFORM_ANDROID
 #define VX_ASSERT(_Expression) _assert(_Expression)
+#elif _VX_PLATFORM_LINUX
+#define VX_ASSERT(_Expression) assert(_Expression)
 
 #else // _VX_ANDROID
 
@@ -36,7 +46,7 @@
 #define VX_ASSERT(_Expression) ((void)0)
 #endif // _VX_ASSERT
 
-#if defined _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 #define VX_CALLCONV 
 #define _VX_CALLCONV_TYPE 0
 #elif defined(_VX_CUDA) || defined (_VX_GCC)
@@ -47,7 +57,10 @@
 #define _VX_CALLCONV_TYPE 1
 #endif
 
-#if defined (_VX_GCC)
+#if defined(_VX_PLATFORM_LINUX)
+#define VX_GLOBALCONST static const
+#define VX_GLOBAL static
+#elif defined (_VX_GCC)
 #define VX_GLOBALCONST extern const __attribute__((selectany))
 #define VX_GLOBAL extern __attribute__((selectany))
 #elif defined (_VX_CLANG) || defined(_VX_PLATFORM_ANDROID)
@@ -58,7 +71,7 @@
 #define VX_GLOBALCONST extern const __declspec(selectany)
 #endif
 
-#if _VX_PLATFORM_ANDROID
+#if _VX_PLATFORM_ANDROID || _VX_PLATFORM_LINUX
 #define VX_ALIGN(X) __attribute__((aligned(X)))
 #elif defined(_VX_GCC) || defined(_VX_CLANG) || (_MSC_VER > 1800)
 #define VX_ALIGN(X) alignas(X)
@@ -201,7 +201,7 @@ namespace vx
 	{
 		static constexpr auto get()
 		{
-			return detail::numeric_builder<detail::num_digits(x), x, '\0'>::type{};
+			return typename detail::numeric_builder<detail::num_digits(x), x, '\0'>::type{};
 		}
 	};
 
@@ -78,6 +78,14 @@ namespace vx
 		typedef Aligned64 type;
 	};
 
+	/*
+	a type is trivially relocatable if moving it to a new address with memcpy and not running the destructor of the old copy
+	is the same as move constructing and destroying it. Containers then grow through Allocator::reallocate, which can
+	extend in place or use realloc/mremap. Specialize for types that own memory but hold no pointers into themselves.
+	*/
+	template<typename T>
+	struct is_trivially_relocatable : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
 	namespace detail
 	{
 		template<class T, size_t ALIGN>
@@ -25,6 +25,7 @@ SOFTWARE.
 
 #include <vxLib/platform.h>
 #include <stdint.h>
+#include <stddef.h>
 
 typedef int8_t s8;
 typedef int16_t s16;
@@ -44,7 +45,7 @@ static_assert(sizeof(u8) == 1, "Wrong type size");
 static_assert(sizeof(s16) == 2, "Wrong type size");
 static_assert(sizeof(u16) == 2, "Wrong type size");
 static_assert(sizeof(s32) == 4, "Wrong type size");
-#ifndef  _VX_PLATFORM_ANDROID
+#if !defined(_VX_PLATFORM_ANDROID) && !defined(_VX_PLATFORM_LINUX)
 static_assert(sizeof(s32) == sizeof(long), "Wrong type size");
 #endif // ! _VX_PLATFORM_ANDROID
 static_assert(sizeof(u32) == 4, "Wrong type size");
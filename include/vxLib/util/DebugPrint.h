@@ -27,6 +27,7 @@ SOFTWARE.
 
 #include <vxLib/types.h>
 #include <cstdio>
+#include <cstdarg>
 
 namespace vx
 {
@@ -25,6 +25,9 @@ SOFTWARE.
 */
 
 #include <vxLib/types.h>
+#ifdef _VX_PLATFORM_WINDOWS
+#include <intrin.h>
+#endif
 
 namespace vx
 {
@@ -61,7 +64,7 @@ namespace vx
 			30, 0, 0, 0, 0, 23, 0, 19, 29, 0, 22, 18, 28, 17, 16, 0
 		};
 
-		x = (x & -int(x)) * 0x0450fbaf;
+		x = (x & (0 - x)) * 0x0450fbaf;
 		return table[x >> 26];
 	}
 
@@ -78,4 +81,28 @@ namespace vx
 
 		return nlz(x);
 	}
+
+	// x must not be zero
+	inline u32 ntz64(u64 x)
+	{
+#ifdef _VX_PLATFORM_WINDOWS
+		unsigned long index = 0;
+		_BitScanForward64(&index, x);
+		return index;
+#else
+		return (u32)__builtin_ctzll(x);
+#endif
+	}
+
+	// x must not be zero
+	inline u32 nlz64(u64 x)
+	{
+#ifdef _VX_PLATFORM_WINDOWS
+		unsigned long index = 0;
+		_BitScanReverse64(&index, x);
+		return 63 - index;
+#else
+		return (u32)__builtin_clzll(x);
+#endif
+	}
 }
\ No newline at end of file
@@ -22,7 +22,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include <vxLib/util/DebugPrint.h>
-#ifdef  _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 #include <cstdio>
 #else
 #include <Windows.h>
@@ -32,7 +32,7 @@ namespace vx
 {
 	u32 debugPrint::g_verbosity = 0;
 	u16 debugPrint::g_filter = 0;
-#ifdef  _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 	void* debugPrint::g_hConsole = nullptr;
 #else
 	void* debugPrint::g_hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -43,7 +43,7 @@ namespace vx
 		const u32 max = 1023;
 		static char sBuffer[max + 1];
 
-#ifdef  _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 		vsnprintf(sBuffer, max, format, argList);
 #else
 		vsnprintf_s(sBuffer, max, format, argList);
@@ -57,7 +57,7 @@ namespace vx
 	{
 		const u32 max = 1023;
 		static char sBuffer[max + 2];
-#ifdef  _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 		int size = vsnprintf(sBuffer, max, format, argList);
 #else
 		int size = vsnprintf_s(sBuffer, max, format, argList);
@@ -96,7 +96,7 @@ namespace vx
 
 	void setConsoleFormat(u8 channel)
 	{
-#ifdef _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 		const char* color = "";
 		switch (channel)
 		{
@@ -170,7 +170,7 @@ namespace vx
 
 			va_end(argList);
 
-#ifdef _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 			printf("\033[37;40m");
 #else
 			SetConsoleTextAttribute(vx::debugPrint::g_hConsole, 7);
@@ -191,7 +191,7 @@ namespace vx
 
 			va_end(argList);
 
-#ifdef _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 			printf("\033[37;40m");
 #else
 			SetConsoleTextAttribute(vx::debugPrint::g_hConsole, 7);
@@ -22,9 +22,10 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include <vxLib/File.h>
-#ifdef _VX_PLATFORM_ANDROID
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #else
 #include <strsafe.h>
 #include <Windows.h>
@@ -60,7 +61,7 @@ namespace vx
 				return false;
 			}
 #else
-			auto tmp = creat(file, static_cast<s32>(access));
+			auto tmp = ::open(file, O_CREAT | O_TRUNC | static_cast<s32>(access), 0644);
 			if (tmp < 0)
 				return false;
 #endif
@@ -77,7 +78,7 @@ namespace vx
 				return false;
 			}
 #else
-			auto tmp = open(file, O_TRUNC, static_cast<s32>(access));
+			auto tmp = ::open(file, static_cast<s32>(access));
 			if (tmp < 0)
 				return false;
 #endif
@@ -146,7 +147,9 @@ namespace vx
 		if (m_handle == 0)
 			return true;
 
-		return (::close(m_handle) == 0);
+		auto result = (::close(m_handle) == 0);
+		m_handle = 0;
+		return result;
 #endif
 	}
 
@@ -155,7 +158,13 @@ namespace vx
 #ifdef _VX_PLATFORM_WINDOWS
 		return (ReadFile(m_handle, ptr, size, (DWORD*)readBytes, nullptr) != 0);
 #else
-		return (::read(m_handle, ptr, size) >= 0);
+		auto bytes = ::read(m_handle, ptr, size);
+		if (bytes < 0)
+			return false;
+
+		if (readBytes)
+			*readBytes = static_cast<s32>(bytes);
+		return true;
 #endif
 	}
 
@@ -167,7 +176,8 @@ namespace vx
 		auto written = ::write(m_handle, ptr, size);
 		if (written < 0)
 			return false;
-		*pWrittenBytes = written;
+		if (pWrittenBytes)
+			*pWrittenBytes = static_cast<s32>(written);
 		return true;
 #endif
 	}
@@ -177,7 +187,8 @@ namespace vx
 #ifdef _VX_PLATFORM_WINDOWS
 		return (SetEndOfFile(m_handle) != 0);
 #else
-		return (::lseek(m_handle, 0, SEEK_END) >= 0);
+		auto position = ::lseek(m_handle, 0, SEEK_CUR);
+		return (position >= 0) && (::ftruncate(m_handle, position) == 0);
 #endif
 	}
 
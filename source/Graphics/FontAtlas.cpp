@@ -22,6 +22,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include <vxlib/Graphics/FontAtlas.h>
+#include <vxLib/Container/EytzingerIndex.h>
 #include <algorithm>
 
 namespace vx
@@ -54,17 +55,18 @@ namespace vx
 
 		FontAtlas::FontAtlas()
 			:m_data(),
-			m_end(nullptr),
+			m_entryCount(0),
 			m_allocatedSize(0)
 		{
 		}
 
 		FontAtlas::FontAtlas(FontAtlas &&rhs)
 			: m_data(rhs.m_data),
-			m_end(rhs.m_end),
+			m_entryCount(rhs.m_entryCount),
 			m_allocatedSize(rhs.m_allocatedSize)
 		{
 			rhs.m_data = nullptr;
+			rhs.m_entryCount = 0;
 			rhs.m_allocatedSize = 0;
 		}
 
@@ -77,7 +79,7 @@ namespace vx
 			if (this != &rhs)
 			{
 				std::swap(m_data, rhs.m_data);
-				std::swap(m_end, rhs.m_end);
+				std::swap(m_entryCount, rhs.m_entryCount);
 				std::swap(m_allocatedSize, rhs.m_allocatedSize);
 			}
 			return *this;
@@ -88,7 +90,7 @@ namespace vx
 			vx::AllocatedBlock block = {(u8*)m_data, m_allocatedSize};
 
 			m_data = nullptr;
-			m_end = nullptr;
+			m_entryCount = 0;
 			m_allocatedSize = 0;
 
 			return block;
@@ -233,7 +235,8 @@ namespace vx
 
 			VX_ASSERT(entryCount != 0);
 
-			auto allocatedBlock = allocFn(sizeof(FontAtlasEntry) * entryCount, __alignof(FontAtlasEntry));
+			// entries are read into m_data[1..entryCount], m_data[0] is the unused slot of the eytzinger layout
+			auto allocatedBlock = allocFn(sizeof(FontAtlasEntry) * (entryCount + 1), __alignof(FontAtlasEntry));
 			if (allocatedBlock.ptr == nullptr)
 				return false;
 
@@ -244,15 +247,12 @@ namespace vx
 			{
 				auto entry = readEntry(infile);
 
-				m_data[i] = entry;
+				m_data[i + 1] = entry;
 			}
 
-			m_end = m_data + entryCount;
+			m_entryCount = entryCount;
 
-			std::sort(m_data, m_end, [](const FontAtlasEntry &l, const FontAtlasEntry &r)
-			{
-				return l.code < r.code;
-			});
+			buildSearchLayout();
 
 			return true;
 		}
@@ -286,7 +286,8 @@ namespace vx
 			//ptr += r;
 			ptr += sizeof(u32);
 
-			auto allocatedBlock = allocFn(sizeof(FontAtlasEntry) * entryCount, __alignof(FontAtlasEntry));
+			// entries are read into m_data[1..entryCount], m_data[0] is the unused slot of the eytzinger layout
+			auto allocatedBlock = allocFn(sizeof(FontAtlasEntry) * (entryCount + 1), __alignof(FontAtlasEntry));
 			if (allocatedBlock.ptr == nullptr)
 				return false;
 
@@ -300,17 +301,52 @@ namespace vx
 
 				ptr += n;
 
-				m_data[i] = entry;
+				m_data[i + 1] = entry;
 			}
 
-			m_end = m_data + entryCount;
+			m_entryCount = entryCount;
+
+			buildSearchLayout();
 
-			std::sort(m_data, m_end, [](const FontAtlasEntry &l, const FontAtlasEntry &r)
+			return true;
+		}
+
+		void FontAtlas::buildSearchLayout()
+		{
+			enum : u32 { PlacedBit = 0x80000000 };
+
+			auto entries = m_data + 1;
+			std::sort(entries, entries + m_entryCount, [](const FontAtlasEntry &l, const FontAtlasEntry &r)
 			{
 				return l.code < r.code;
 			});
 
-			return true;
+			// moves the sorted entries into eytzinger order one permutation cycle at a time, unicode code points
+			// never use the top bit, so it marks the slots that already hold their final entry
+			for (u32 k = 1; k <= m_entryCount; ++k)
+			{
+				if (m_data[k].code & PlacedBit)
+					continue;
+
+				auto first = m_data[k];
+				auto current = k;
+				for (;;)
+				{
+					auto src = (u32)detail::eytzingerRank(current, m_entryCount) + 1;
+					m_data[current] = (src == k) ? first : m_data[src];
+					m_data[current].code |= PlacedBit;
+
+					if (src == k)
+						break;
+
+					current = src;
+				}
+			}
+
+			for (u32 k = 1; k <= m_entryCount; ++k)
+			{
+				m_data[k].code &= ~(u32)PlacedBit;
+			}
 		}
 
 		const FontAtlasEntry* FontAtlas::getEntry(u32 code) const
@@ -322,11 +358,11 @@ namespace vx
 				return entry.code < key;
 			};
 
-			auto it = std::lower_bound(m_data, m_end, code, cmp);
+			auto k = eytzinger_lower_bound(m_data, m_entryCount, code, cmp);
 
-			if (it != m_end && (it->code == code))
+			if (k != 0 && (m_data[k].code == code))
 			{
-				pEntry = &*it;
+				pEntry = &m_data[k];
 			}
 
 			return pEntry;
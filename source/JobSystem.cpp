@@ -0,0 +1,419 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <vxLib/JobSystem.h>
+#include <vxLib/Allocator/LinearAllocator.h>
+#include <vxLib/Allocator/Mallocator.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	enum : u32 { SpinCount = 64 };
+
+	/*
+	fixed size Chase-Lev deque (Le, Pop, Cohen, Zappa Nardelli 2013), the fences of the paper are
+	expressed as seq_cst operations on top and bottom
+	*/
+	class WorkStealingQueue
+	{
+		VX_ALIGN(64) std::atomic<s64> m_top;
+		VX_ALIGN(64) std::atomic<s64> m_bottom;
+		std::atomic<vx::Job*>* m_buffer;
+		s64 m_mask;
+
+	public:
+		WorkStealingQueue() :m_top(0), m_bottom(0), m_buffer(nullptr), m_mask(0) {}
+
+		static size_t getRequiredBytes(u32 capacity) { return sizeof(std::atomic<vx::Job*>) * capacity; }
+
+		// capacity needs to be a power of two
+		void initialize(u8* memory, u32 capacity)
+		{
+			m_buffer = (std::atomic<vx::Job*>*)memory;
+			for (u32 i = 0; i < capacity; ++i)
+			{
+				new (&m_buffer[i]) std::atomic<vx::Job*>(nullptr);
+			}
+			m_mask = capacity - 1;
+		}
+
+		// owner only
+		bool push(vx::Job* job)
+		{
+			auto b = m_bottom.load(std::memory_order_relaxed);
+			auto t = m_top.load(std::memory_order_acquire);
+			if (b - t > m_mask)
+				return false;
+
+			m_buffer[b & m_mask].store(job, std::memory_order_relaxed);
+			m_bottom.store(b + 1, std::memory_order_release);
+			return true;
+		}
+
+		// owner only
+		vx::Job* pop()
+		{
+			auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(b, std::memory_order_seq_cst);
+			auto t = m_top.load(std::memory_order_seq_cst);
+			if (t > b)
+			{
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			auto job = m_buffer[b & m_mask].load(std::memory_order_relaxed);
+			if (t == b)
+			{
+				// last job, race the thieves for it
+				if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					job = nullptr;
+
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		vx::Job* steal()
+		{
+			auto t = m_top.load(std::memory_order_seq_cst);
+			auto b = m_bottom.load(std::memory_order_seq_cst);
+			if (t >= b)
+				return nullptr;
+
+			auto job = m_buffer[t & m_mask].load(std::memory_order_relaxed);
+			if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+
+			return job;
+		}
+	};
+
+	thread_local const vx::JobSystem* s_jobSystem = nullptr;
+	thread_local u32 s_workerIndex = vx::JobSystem::InvalidWorker;
+}
+
+namespace vx
+{
+	struct JobSystem::Data
+	{
+		struct VX_ALIGN(64) Worker
+		{
+			WorkStealingQueue queue;
+			LinearAllocator allocator;
+			AllocatedBlock block = { nullptr, 0 };
+			u32 randomState;
+		};
+
+		Worker* workers;
+		std::thread* threads;
+		u32 workerCount;
+		std::atomic<u32> pendingJobs;
+		std::atomic<u32> activeJobs;
+		std::atomic<u32> sleepingWorkers;
+		std::atomic<bool> running;
+		std::mutex mutex;
+		std::condition_variable wakeup;
+		Mallocator allocator;
+
+		Data() :workers(nullptr), threads(nullptr), workerCount(0), pendingJobs(0), activeJobs(0), sleepingWorkers(0), running(false) {}
+
+		Job* findJob(u32 workerIndex)
+		{
+			Job* job = nullptr;
+			if (workerIndex != InvalidWorker)
+			{
+				job = workers[workerIndex].queue.pop();
+			}
+
+			if (job == nullptr && workerCount > 1)
+			{
+				// xorshift, picks the first victim so thieves spread over the queues
+				u32 victim = 0;
+				if (workerIndex != InvalidWorker)
+				{
+					auto &x = workers[workerIndex].randomState;
+					x ^= x << 13;
+					x ^= x >> 17;
+					x ^= x << 5;
+					victim = x;
+				}
+
+				for (u32 i = 0; i < workerCount && job == nullptr; ++i)
+				{
+					auto index = (victim + i) % workerCount;
+					if (index != workerIndex)
+					{
+						job = workers[index].queue.steal();
+					}
+				}
+			}
+
+			if (job != nullptr)
+			{
+				pendingJobs.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			return job;
+		}
+
+		void execute(Job* job)
+		{
+			auto counter = job->counter;
+			job->execute(job);
+
+			if (counter != nullptr)
+			{
+				counter->value.fetch_sub(1, std::memory_order_release);
+			}
+			activeJobs.fetch_sub(1, std::memory_order_release);
+		}
+
+		void workerMain(u32 workerIndex)
+		{
+			for (;;)
+			{
+				Job* job = nullptr;
+				for (u32 i = 0; i < SpinCount && job == nullptr; ++i)
+				{
+					job = findJob(workerIndex);
+					if (job == nullptr)
+					{
+						std::this_thread::yield();
+					}
+				}
+
+				if (job != nullptr)
+				{
+					execute(job);
+					continue;
+				}
+
+				// pendingJobs and sleepingWorkers are seq_cst on both sides, either submit sees the sleeper or we see the job
+				std::unique_lock<std::mutex> lock(mutex);
+				sleepingWorkers.fetch_add(1);
+				while (pendingJobs.load() == 0 && running.load())
+				{
+					wakeup.wait(lock);
+				}
+				sleepingWorkers.fetch_sub(1);
+
+				if (!running.load() && pendingJobs.load() == 0)
+					break;
+			}
+		}
+	};
+
+	JobSystem::JobSystem() :m_data(nullptr) {}
+
+	JobSystem::~JobSystem()
+	{
+		shutdown();
+	}
+
+	bool JobSystem::initialize(u32 workerCount, size_t frameBytesPerWorker, u32 queueCapacity)
+	{
+		VX_ASSERT(m_data == nullptr);
+
+		if (workerCount == 0)
+		{
+			workerCount = std::thread::hardware_concurrency();
+			workerCount = (workerCount == 0) ? 1 : workerCount;
+		}
+
+		u32 capacity = 2;
+		while (capacity < queueCapacity)
+			capacity <<= 1;
+
+		auto queueBytes = getAlignedSize(WorkStealingQueue::getRequiredBytes(capacity), 64);
+
+		auto data = new Data();
+		data->workers = new Data::Worker[workerCount];
+		data->workerCount = workerCount;
+		for (u32 i = 0; i < workerCount; ++i)
+		{
+			auto &worker = data->workers[i];
+			worker.block = data->allocator.allocate(queueBytes + frameBytesPerWorker, 64);
+			if (worker.block.ptr == nullptr)
+			{
+				m_data = data;
+				shutdown();
+				return false;
+			}
+
+			worker.queue.initialize(worker.block.ptr, capacity);
+			worker.allocator.initialize({ worker.block.ptr + queueBytes, frameBytesPerWorker });
+			worker.randomState = 0x9e3779b9 * (i + 1);
+		}
+
+		m_data = data;
+		s_jobSystem = this;
+		s_workerIndex = 0;
+
+		data->running.store(true);
+		data->threads = new std::thread[workerCount - 1];
+		for (u32 i = 1; i < workerCount; ++i)
+		{
+			data->threads[i - 1] = std::thread([this, data, i]()
+			{
+				s_jobSystem = this;
+				s_workerIndex = i;
+				data->workerMain(i);
+			});
+		}
+
+		return true;
+	}
+
+	void JobSystem::shutdown()
+	{
+		if (m_data == nullptr)
+			return;
+
+		auto data = m_data;
+		if (data->threads != nullptr)
+		{
+			// the calling thread helps until every queue is empty
+			while (data->activeJobs.load(std::memory_order_acquire) != 0)
+			{
+				auto job = data->findJob(getCurrentWorker());
+				if (job != nullptr)
+				{
+					data->execute(job);
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(data->mutex);
+				data->running.store(false);
+			}
+			data->wakeup.notify_all();
+
+			for (u32 i = 1; i < data->workerCount; ++i)
+			{
+				data->threads[i - 1].join();
+			}
+			delete[] data->threads;
+		}
+
+		for (u32 i = 0; i < data->workerCount; ++i)
+		{
+			auto &worker = data->workers[i];
+			if (worker.block.ptr != nullptr)
+			{
+				worker.allocator.release();
+				data->allocator.deallocate(worker.block);
+			}
+		}
+
+		delete[] data->workers;
+		delete data;
+		m_data = nullptr;
+
+		if (s_jobSystem == this)
+		{
+			s_jobSystem = nullptr;
+			s_workerIndex = InvalidWorker;
+		}
+	}
+
+	void* JobSystem::allocateJob(size_t size, size_t alignment)
+	{
+		auto workerIndex = getCurrentWorker();
+		if (workerIndex == InvalidWorker)
+			return nullptr;
+
+		return m_data->workers[workerIndex].allocator.allocate(size, alignment).ptr;
+	}
+
+	void JobSystem::submit(Job* job)
+	{
+		auto data = m_data;
+		auto &worker = data->workers[getCurrentWorker()];
+
+		if (job->counter != nullptr)
+		{
+			job->counter->value.fetch_add(1, std::memory_order_relaxed);
+		}
+		data->activeJobs.fetch_add(1, std::memory_order_relaxed);
+
+		// counted before the push so a thief never takes pendingJobs below zero
+		data->pendingJobs.fetch_add(1);
+		if (!worker.queue.push(job))
+		{
+			data->pendingJobs.fetch_sub(1, std::memory_order_relaxed);
+			data->execute(job);
+			return;
+		}
+
+		if (data->sleepingWorkers.load() != 0)
+		{
+			std::lock_guard<std::mutex> lock(data->mutex);
+			data->wakeup.notify_one();
+		}
+	}
+
+	void JobSystem::wait(JobCounter* counter)
+	{
+		auto data = m_data;
+		auto workerIndex = getCurrentWorker();
+		while (!counter->isDone())
+		{
+			auto job = data->findJob(workerIndex);
+			if (job != nullptr)
+			{
+				data->execute(job);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::resetFrame()
+	{
+		VX_ASSERT(m_data->activeJobs.load(std::memory_order_acquire) == 0);
+
+		for (u32 i = 0; i < m_data->workerCount; ++i)
+		{
+			m_data->workers[i].allocator.deallocateAll();
+		}
+	}
+
+	u32 JobSystem::getWorkerCount() const
+	{
+		return (m_data != nullptr) ? m_data->workerCount : 0;
+	}
+
+	u32 JobSystem::getCurrentWorker() const
+	{
+		return (s_jobSystem == this) ? s_workerIndex : InvalidWorker;
+	}
+}
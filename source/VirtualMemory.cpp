@@ -0,0 +1,254 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Dennis Wandschura
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <vxLib/Allocator/VirtualMemory.h>
+#include <cstring>
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <Windows.h>
+#endif
+
+namespace
+{
+	enum : size_t { HugePageSize = 2 MBYTE };
+}
+
+namespace vx
+{
+#if defined(_VX_PLATFORM_ANDROID) || defined(_VX_PLATFORM_LINUX)
+	size_t getVirtualMemoryPageSize()
+	{
+		static const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+		return pageSize;
+	}
+
+	u8* reserveVirtualMemory(size_t size)
+	{
+		auto ptr = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		return (ptr == MAP_FAILED) ? nullptr : (u8*)ptr;
+	}
+
+	bool commitVirtualMemory(u8* ptr, size_t size)
+	{
+		return ::mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+	}
+
+	void decommitVirtualMemory(u8* ptr, size_t size)
+	{
+		::madvise(ptr, size, MADV_DONTNEED);
+		::mprotect(ptr, size, PROT_NONE);
+	}
+
+	void releaseVirtualMemory(u8* ptr, size_t size)
+	{
+		::munmap(ptr, size);
+	}
+
+	size_t getPageSize(PageType type)
+	{
+		return (type == PageType::Default) ? getVirtualMemoryPageSize() : HugePageSize;
+	}
+
+	namespace
+	{
+		// false if numaNode is a node the pages could not be bound to
+		bool bindToNumaNode(u8* ptr, size_t size, s32 numaNode)
+		{
+			if (numaNode < 0)
+				return true;
+
+#ifdef SYS_mbind
+			if (numaNode >= 64)
+				return false;
+
+			// MPOL_BIND from numaif.h, which would pull in libnuma
+			const int mpolBind = 2;
+			unsigned long nodeMask = 1ul << numaNode;
+			// the kernel drops the last bit of maxnode
+			return ::syscall(SYS_mbind, ptr, size, mpolBind, &nodeMask, sizeof(nodeMask) * 8 + 1, 0) == 0;
+#else
+			(void)ptr;
+			(void)size;
+			return false;
+#endif
+		}
+
+		u8* mapTransparentHuge(size_t size)
+		{
+			// over-reserve so the range can be trimmed to a 2 MiB boundary
+			auto ptr = (u8*)::mmap(nullptr, size + HugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (ptr == MAP_FAILED)
+				return nullptr;
+
+			auto aligned = (u8*)(((size_t)ptr + HugePageSize - 1) & ~(size_t(HugePageSize) - 1));
+			if (aligned != ptr)
+				::munmap(ptr, aligned - ptr);
+
+			auto tail = (ptr + size + HugePageSize) - (aligned + size);
+			if (tail != 0)
+				::munmap(aligned + size, tail);
+
+#ifdef MADV_HUGEPAGE
+			::madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+			return aligned;
+		}
+	}
+
+	u8* allocatePages(size_t size, PageType type, s32 numaNode)
+	{
+		u8* ptr = nullptr;
+		switch (type)
+		{
+		case PageType::Huge:
+		{
+#ifdef MAP_HUGETLB
+			auto p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (p != MAP_FAILED)
+			{
+				ptr = (u8*)p;
+				break;
+			}
+#endif
+			ptr = mapTransparentHuge(size);
+		}break;
+		case PageType::TransparentHuge:
+			ptr = mapTransparentHuge(size);
+			break;
+		default:
+		{
+			auto p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			ptr = (p == MAP_FAILED) ? nullptr : (u8*)p;
+		}break;
+		}
+
+		if (ptr && !bindToNumaNode(ptr, size, numaNode))
+		{
+			::munmap(ptr, size);
+			ptr = nullptr;
+		}
+
+		return ptr;
+	}
+
+	u8* reallocatePages(u8* ptr, size_t size, size_t newSize, PageType type, s32 numaNode)
+	{
+#ifdef MREMAP_MAYMOVE
+		// a failed bind of the grown tail could not be undone after mremap moved the pages, bound pages are copied
+		if (type == PageType::Default && numaNode < 0)
+		{
+			auto p = ::mremap(ptr, size, newSize, MREMAP_MAYMOVE);
+			return (p == MAP_FAILED) ? nullptr : (u8*)p;
+		}
+#endif
+		auto newPtr = allocatePages(newSize, type, numaNode);
+		if (newPtr)
+		{
+			::memcpy(newPtr, ptr, (size < newSize) ? size : newSize);
+			deallocatePages(ptr, size);
+		}
+
+		return newPtr;
+	}
+
+	void deallocatePages(u8* ptr, size_t size)
+	{
+		::munmap(ptr, size);
+	}
+#else
+	size_t getVirtualMemoryPageSize()
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwPageSize;
+	}
+
+	u8* reserveVirtualMemory(size_t size)
+	{
+		return (u8*)VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+	}
+
+	bool commitVirtualMemory(u8* ptr, size_t size)
+	{
+		return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+	}
+
+	void decommitVirtualMemory(u8* ptr, size_t size)
+	{
+		VirtualFree(ptr, size, MEM_DECOMMIT);
+	}
+
+	void releaseVirtualMemory(u8* ptr, size_t)
+	{
+		VirtualFree(ptr, 0, MEM_RELEASE);
+	}
+
+	size_t getPageSize(PageType type)
+	{
+		if (type == PageType::Default)
+			return getVirtualMemoryPageSize();
+
+		auto largePageSize = GetLargePageMinimum();
+		return (largePageSize > HugePageSize) ? largePageSize : HugePageSize;
+	}
+
+	u8* allocatePages(size_t size, PageType type, s32 numaNode)
+	{
+		DWORD allocationType = MEM_RESERVE | MEM_COMMIT;
+		if (type == PageType::Huge)
+		{
+			// needs SeLockMemoryPrivilege, fall back to normal pages without it
+			auto ptr = (numaNode >= 0)
+				? VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, allocationType | MEM_LARGE_PAGES, PAGE_READWRITE, numaNode)
+				: VirtualAlloc(nullptr, size, allocationType | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (ptr)
+				return (u8*)ptr;
+		}
+
+		auto ptr = (numaNode >= 0)
+			? VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, allocationType, PAGE_READWRITE, numaNode)
+			: VirtualAlloc(nullptr, size, allocationType, PAGE_READWRITE);
+		return (u8*)ptr;
+	}
+
+	u8* reallocatePages(u8* ptr, size_t size, size_t newSize, PageType type, s32 numaNode)
+	{
+		auto newPtr = allocatePages(newSize, type, numaNode);
+		if (newPtr)
+		{
+			::memcpy(newPtr, ptr, (size < newSize) ? size : newSize);
+			deallocatePages(ptr, size);
+		}
+
+		return newPtr;
+	}
+
+	void deallocatePages(u8* ptr, size_t)
+	{
+		VirtualFree(ptr, 0, MEM_RELEASE);
+	}
+#endif
+}
\ No newline at end of file
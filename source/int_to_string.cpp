@@ -1,7 +1,7 @@
 #include <vxLib/print.h>
 #include <cstring>
 
-#include <vxLib/Container/Array.h>
+#include <vxLib/Container/array.h>
 
 namespace vx
 {
@@ -1,4 +1,4 @@
-#include <vxlib/string.h>
+#include <vxLib/string.h>
 
 namespace vx
 {